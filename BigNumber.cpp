@@ -0,0 +1,377 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "BigNumber.h"
+
+#include "Util.h"
+#include <cctype>
+
+namespace {
+
+using Limbs = std::vector<std::uint32_t>;
+
+void trim(Limbs &limbs) {
+    while (!limbs.empty() && (limbs.back() == 0))
+        limbs.pop_back();
+}
+
+int compareMagnitudes(const Limbs &a, const Limbs &b) {
+    if (a.size() != b.size())
+        return (a.size() < b.size()) ? -1 : 1;
+
+    for (std::size_t i = a.size(); i-- > 0; ) {
+        if (a[i] != b[i])
+            return (a[i] < b[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+Limbs addMagnitudes(const Limbs &a, const Limbs &b) {
+    const Limbs &longer = (a.size() >= b.size()) ? a : b;
+    const Limbs &shorter = (a.size() >= b.size()) ? b : a;
+
+    Limbs result(longer.size() + 1);
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < longer.size(); ++i) {
+        carry += static_cast<std::uint64_t>(longer[i]) + ((i < shorter.size()) ? shorter[i] : 0);
+        result[i] = static_cast<std::uint32_t>(carry);
+        carry >>= 32;
+    }
+    result[longer.size()] = static_cast<std::uint32_t>(carry);
+
+    trim(result);
+    return result;
+}
+
+// The magnitude of a must not be smaller than the one of b.
+Limbs subtractMagnitudes(const Limbs &a, const Limbs &b) {
+    Limbs result(a.size());
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::int64_t difference = static_cast<std::int64_t>(a[i]) - ((i < b.size()) ? b[i] : 0) - borrow;
+        borrow = (difference < 0) ? 1 : 0;
+        result[i] = static_cast<std::uint32_t>(difference);
+    }
+
+    trim(result);
+    return result;
+}
+
+Limbs multiplyMagnitudes(const Limbs &a, const Limbs &b) {
+    if (a.empty() || b.empty())
+        return Limbs();
+
+    Limbs result(a.size() + b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            carry += static_cast<std::uint64_t>(a[i]) * b[j] + result[i + j];
+            result[i + j] = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
+        }
+        result[i + b.size()] = static_cast<std::uint32_t>(carry);
+    }
+
+    trim(result);
+    return result;
+}
+
+// Divides the magnitude in place and returns the remainder.
+std::uint32_t divideByLimb(Limbs &limbs, std::uint32_t divisor) {
+    std::uint64_t remainder = 0;
+    for (std::size_t i = limbs.size(); i-- > 0; ) {
+        std::uint64_t current = (remainder << 32) | limbs[i];
+        limbs[i] = static_cast<std::uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+
+    trim(limbs);
+    return static_cast<std::uint32_t>(remainder);
+}
+
+// Knuth's algorithm D, for a divisor of at least two limbs that is not greater than the dividend.
+void divideMagnitudes(const Limbs &u, const Limbs &v, Limbs &quotient, Limbs &remainder) {
+    const std::uint64_t base = 1ull << 32;
+    const std::size_t n = v.size();
+    const std::size_t m = u.size();
+
+    // Both are shifted so that the top bit of the divisor is set, which keeps the estimates of the
+    // quotient digits at most two above the right ones.
+    int shift = 0;
+    for (std::uint32_t top = v.back(); (top & 0x80000000u) == 0; top <<= 1)
+        ++shift;
+    auto shifted = [shift](std::uint32_t high, std::uint32_t low) {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(high) << shift) | (shift ? low >> (32 - shift) : 0));
+    };
+
+    Limbs vn(n);
+    for (std::size_t i = n - 1; i > 0; --i)
+        vn[i] = shifted(v[i], v[i - 1]);
+    vn[0] = v[0] << shift;
+
+    Limbs un(m + 1);
+    un[m] = shifted(0, u[m - 1]);
+    for (std::size_t i = m - 1; i > 0; --i)
+        un[i] = shifted(u[i], u[i - 1]);
+    un[0] = u[0] << shift;
+
+    quotient.assign(m - n + 1, 0);
+    for (std::size_t j = m - n + 1; j-- > 0; ) {
+        std::uint64_t numerator = (static_cast<std::uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+        std::uint64_t estimate = numerator / vn[n - 1];
+        std::uint64_t rest = numerator % vn[n - 1];
+        while ((estimate >= base) || (estimate * vn[n - 2] > ((rest << 32) | un[j + n - 2]))) {
+            --estimate;
+            rest += vn[n - 1];
+            if (rest >= base)
+                break;
+        }
+
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t product = estimate * vn[i];
+            std::int64_t difference = static_cast<std::int64_t>(un[i + j]) - borrow - static_cast<std::int64_t>(product & 0xFFFFFFFFu);
+            un[i + j] = static_cast<std::uint32_t>(difference);
+            borrow = static_cast<std::int64_t>(product >> 32) - (difference >> 32);
+        }
+        std::int64_t difference = static_cast<std::int64_t>(un[j + n]) - borrow;
+        un[j + n] = static_cast<std::uint32_t>(difference);
+
+        // The estimate was still one too big: add the divisor back.
+        if (difference < 0) {
+            --estimate;
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                carry += static_cast<std::uint64_t>(un[i + j]) + vn[i];
+                un[i + j] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            un[j + n] += static_cast<std::uint32_t>(carry);
+        }
+        quotient[j] = static_cast<std::uint32_t>(estimate);
+    }
+
+    remainder.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+        remainder[i] = static_cast<std::uint32_t>(((static_cast<std::uint64_t>(un[i + 1]) << 32) | un[i]) >> shift);
+
+    trim(quotient);
+    trim(remainder);
+}
+
+}
+
+BigNumber::Big::Big(bool negative, Limbs &&limbs): references(1), negative(negative), limbs(std::move(limbs)) {}
+
+std::string BigNumber::toString() const {
+    if (!big)
+        return std::to_string(small);
+
+    // Groups of 9 digits, from the least significant one.
+    Limbs limbs = big->limbs;
+    std::vector<std::uint32_t> groups;
+    while (!limbs.empty())
+        groups.push_back(divideByLimb(limbs, 1000000000));
+
+    std::string result = big->negative ? "-" : "";
+    result += std::to_string(groups.back());
+    for (std::size_t i = groups.size() - 1; i-- > 0; ) {
+        std::string group = std::to_string(groups[i]);
+        result.append(9 - group.size(), '0');
+        result += group;
+    }
+    return result;
+}
+
+bool BigNumber::fromString(const std::string &s, BigNumber &number) {
+    std::size_t i = 0;
+    while ((i < s.size()) && std::isspace(static_cast<unsigned char>(s[i])))
+        ++i;
+
+    bool negative = false;
+    if ((i < s.size()) && ((s[i] == '+') || (s[i] == '-')))
+        negative = (s[i++] == '-');
+
+    auto isDigit = [&s](std::size_t position) {
+        return (position < s.size()) && std::isdigit(static_cast<unsigned char>(s[position]));
+    };
+    if (!isDigit(i))
+        return false;
+
+    // The digits are read into a 64-bit value while they fit, and only then into limbs.
+    std::uint64_t value = 0;
+    for (; isDigit(i) && (value <= (UINT64_MAX - 9) / 10); ++i)
+        value = value * 10 + static_cast<std::uint64_t>(s[i] - '0');
+
+    if (!isDigit(i)) {
+        if (!negative && (value <= static_cast<std::uint64_t>(LLONG_MAX))) {
+            number = BigNumber(static_cast<long long>(value));
+            return true;
+        }
+        if (negative && (value <= static_cast<std::uint64_t>(LLONG_MAX))) {
+            number = BigNumber(-static_cast<long long>(value));
+            return true;
+        }
+    }
+
+    Limbs limbs = {static_cast<std::uint32_t>(value), static_cast<std::uint32_t>(value >> 32)};
+    for (; isDigit(i); ++i) {
+        std::uint64_t carry = static_cast<std::uint64_t>(s[i] - '0');
+        for (std::uint32_t &limb : limbs) {
+            carry += static_cast<std::uint64_t>(limb) * 10;
+            limb = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0)
+            limbs.push_back(static_cast<std::uint32_t>(carry));
+    }
+
+    number = make(negative, std::move(limbs));
+    return true;
+}
+
+util::Hash BigNumber::hash() const {
+    util::Hash hash;
+    if (!big) {
+        hash.first = hash.second = static_cast<std::uint64_t>(small);
+        return hash;
+    }
+
+    hash.first = hash.second = big->negative ? 1 : 0;
+    for (std::uint32_t limb : big->limbs) {
+        hash.first = util::mix(hash.first ^ limb);
+        hash.second = util::mixOther(hash.second ^ limb);
+    }
+    return hash;
+}
+
+// Number with the sign and magnitude, stored inline if it fits in a long long.
+BigNumber BigNumber::make(bool negative, Limbs &&limbs) {
+    trim(limbs);
+
+    if (limbs.size() <= 2) {
+        std::uint64_t value = limbs.empty() ? 0 : limbs[0];
+        if (limbs.size() == 2)
+            value |= static_cast<std::uint64_t>(limbs[1]) << 32;
+
+        if (!negative && (value <= static_cast<std::uint64_t>(LLONG_MAX)))
+            return BigNumber(static_cast<long long>(value));
+        if (negative && (value <= static_cast<std::uint64_t>(LLONG_MAX)))
+            return BigNumber(-static_cast<long long>(value));
+        if (negative && (value == static_cast<std::uint64_t>(LLONG_MAX) + 1))
+            return BigNumber(LLONG_MIN);
+    }
+
+    BigNumber number;
+    number.big = new Big(negative, std::move(limbs));
+    return number;
+}
+
+// Limbs of the magnitude: the ones of the number if it is big, and otherwise storage filled with them.
+const BigNumber::Limbs &BigNumber::magnitude(const BigNumber &number, Limbs &storage) {
+    if (number.big)
+        return number.big->limbs;
+
+    std::uint64_t value = (number.small < 0) ? 0 - static_cast<std::uint64_t>(number.small) : static_cast<std::uint64_t>(number.small);
+    storage = {static_cast<std::uint32_t>(value), static_cast<std::uint32_t>(value >> 32)};
+    trim(storage);
+    return storage;
+}
+
+BigNumber BigNumber::add(const BigNumber &a, const BigNumber &b, bool subtract) {
+    bool aNegative = a.isNegative();
+    bool bNegative = b.isNegative() != subtract;
+    Limbs aStorage;
+    Limbs bStorage;
+    const Limbs &x = magnitude(a, aStorage);
+    const Limbs &y = magnitude(b, bStorage);
+
+    if (aNegative == bNegative)
+        return make(aNegative, addMagnitudes(x, y));
+    if (compareMagnitudes(x, y) >= 0)
+        return make(aNegative, subtractMagnitudes(x, y));
+    return make(bNegative, subtractMagnitudes(y, x));
+}
+
+BigNumber BigNumber::multiply(const BigNumber &a, const BigNumber &b) {
+    Limbs aStorage;
+    Limbs bStorage;
+    return make(a.isNegative() != b.isNegative(), multiplyMagnitudes(magnitude(a, aStorage), magnitude(b, bStorage)));
+}
+
+BigNumber BigNumber::divide(const BigNumber &a, const BigNumber &b, bool remainder) {
+    Limbs aStorage;
+    Limbs bStorage;
+    const Limbs &x = magnitude(a, aStorage);
+    const Limbs &y = magnitude(b, bStorage);
+
+    Limbs quotientLimbs;
+    Limbs remainderLimbs;
+    if (compareMagnitudes(x, y) < 0) {
+        remainderLimbs = x;
+    } else if (y.size() == 1) {
+        quotientLimbs = x;
+        remainderLimbs = {divideByLimb(quotientLimbs, y[0])};
+    } else {
+        divideMagnitudes(x, y, quotientLimbs, remainderLimbs);
+    }
+
+    // The quotient is truncated and the remainder has the sign of the dividend.
+    if (remainder)
+        return make(a.isNegative(), std::move(remainderLimbs));
+    return make(a.isNegative() != b.isNegative(), std::move(quotientLimbs));
+}
+
+int BigNumber::compare(const BigNumber &a, const BigNumber &b) {
+    bool aNegative = a.isNegative();
+    if (aNegative != b.isNegative())
+        return aNegative ? -1 : 1;
+
+    Limbs aStorage;
+    Limbs bStorage;
+    int comparison = compareMagnitudes(magnitude(a, aStorage), magnitude(b, bStorage));
+    return aNegative ? -comparison : comparison;
+}
+
+bool BigNumber::isNegative() const {
+    return big ? big->negative : (small < 0);
+}
+
+// Big numbers are beyond the range of long long.
+long long BigNumber::clamp() const {
+    return big->negative ? LLONG_MIN : LLONG_MAX;
+}
+
+void BigNumber::release() {
+    if (big->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete big;
+}
+
+std::ostream &operator<<(std::ostream &os, const BigNumber &number) {
+    return os << number.toString();
+}
+
+std::istream &operator>>(std::istream &is, BigNumber &number) {
+    std::string s;
+    if (is >> s) {
+        if (!BigNumber::fromString(s, number))
+            is.setstate(std::ios::failbit);
+    }
+    return is;
+}
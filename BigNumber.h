@@ -0,0 +1,262 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Util.h"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Signed integer without limits. Values that fit in a long long are stored inline and handled by the
+// inline operators without any allocation, only the ones outside that range are kept in a reference
+// counted array of 32-bit limbs, which is immutable like the contents of SharedString.
+class BigNumber {
+public:
+    BigNumber(long long value = 0);
+    BigNumber(const BigNumber &other);
+    BigNumber(BigNumber &&other) noexcept;
+    ~BigNumber();
+
+    BigNumber &operator=(const BigNumber &other);
+    BigNumber &operator=(BigNumber &&other) noexcept;
+
+    // The closest long long to the value, converted to the integral type.
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    explicit operator T() const;
+
+    std::string toString() const;
+    // Same rules as std::stoll (leading spaces, an optional sign and at least one digit, the rest is
+    // ignored), but the number is never out of range.
+    static bool fromString(const std::string &s, BigNumber &number);
+    // Equal for equal numbers, and the value itself in both halves for the ones stored inline.
+    util::Hash hash() const;
+
+    BigNumber operator-() const;
+    BigNumber &operator++();
+    BigNumber &operator--();
+    BigNumber &operator+=(const BigNumber &other);
+    BigNumber &operator-=(const BigNumber &other);
+    BigNumber &operator*=(const BigNumber &other);
+    BigNumber &operator/=(const BigNumber &other);
+    BigNumber &operator%=(const BigNumber &other);
+
+    friend BigNumber operator+(const BigNumber &a, const BigNumber &b);
+    friend BigNumber operator-(const BigNumber &a, const BigNumber &b);
+    friend BigNumber operator*(const BigNumber &a, const BigNumber &b);
+    // Truncated division like the one of long long. Dividing by 0 is undefined.
+    friend BigNumber operator/(const BigNumber &a, const BigNumber &b);
+    friend BigNumber operator%(const BigNumber &a, const BigNumber &b);
+
+    friend bool operator==(const BigNumber &a, const BigNumber &b);
+    friend bool operator<(const BigNumber &a, const BigNumber &b);
+private:
+    // Magnitude in base 2^32, least significant limb first and without leading zeros.
+    using Limbs = std::vector<std::uint32_t>;
+
+    // The count is atomic because the first stage can copy the same numbers from several threads.
+    struct Big {
+        Big(bool negative, Limbs &&limbs);
+
+        std::atomic<std::size_t> references;
+        bool negative;
+        Limbs limbs;
+    };
+
+    static BigNumber make(bool negative, Limbs &&limbs);
+    static const Limbs &magnitude(const BigNumber &number, Limbs &storage);
+    static BigNumber add(const BigNumber &a, const BigNumber &b, bool subtract);
+    static BigNumber multiply(const BigNumber &a, const BigNumber &b);
+    static BigNumber divide(const BigNumber &a, const BigNumber &b, bool remainder);
+    static int compare(const BigNumber &a, const BigNumber &b);
+
+    bool isNegative() const;
+    long long clamp() const;
+    void release();
+
+    // The value when big is null.
+    long long small;
+    Big *big;
+};
+
+bool operator!=(const BigNumber &a, const BigNumber &b);
+bool operator>(const BigNumber &a, const BigNumber &b);
+bool operator<=(const BigNumber &a, const BigNumber &b);
+bool operator>=(const BigNumber &a, const BigNumber &b);
+
+std::ostream &operator<<(std::ostream &os, const BigNumber &number);
+std::istream &operator>>(std::istream &is, BigNumber &number);
+
+inline BigNumber::BigNumber(long long value): small(value), big(nullptr) {}
+
+inline BigNumber::BigNumber(const BigNumber &other): small(other.small), big(other.big) {
+    if (big)
+        big->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline BigNumber::BigNumber(BigNumber &&other) noexcept: small(other.small), big(other.big) {
+    other.big = nullptr;
+}
+
+inline BigNumber::~BigNumber() {
+    if (big)
+        release();
+}
+
+inline BigNumber &BigNumber::operator=(const BigNumber &other) {
+    if (big || other.big) {
+        BigNumber copy(other);
+        std::swap(big, copy.big);
+    }
+    small = other.small;
+    return *this;
+}
+
+inline BigNumber &BigNumber::operator=(BigNumber &&other) noexcept {
+    std::swap(big, other.big);
+    small = other.small;
+    return *this;
+}
+
+template <typename T, typename>
+inline BigNumber::operator T() const {
+    return static_cast<T>(big ? clamp() : small);
+}
+
+inline BigNumber BigNumber::operator-() const {
+    if (!big && (small != LLONG_MIN))
+        return BigNumber(-small);
+    return add(BigNumber(), *this, true);
+}
+
+inline BigNumber &BigNumber::operator++() {
+    if (!big && (small != LLONG_MAX))
+        ++small;
+    else
+        *this = add(*this, BigNumber(1), false);
+    return *this;
+}
+
+inline BigNumber &BigNumber::operator--() {
+    if (!big && (small != LLONG_MIN))
+        --small;
+    else
+        *this = add(*this, BigNumber(1), true);
+    return *this;
+}
+
+inline BigNumber &BigNumber::operator+=(const BigNumber &other) {
+    return *this = *this + other;
+}
+
+inline BigNumber &BigNumber::operator-=(const BigNumber &other) {
+    return *this = *this - other;
+}
+
+inline BigNumber &BigNumber::operator*=(const BigNumber &other) {
+    return *this = *this * other;
+}
+
+inline BigNumber &BigNumber::operator/=(const BigNumber &other) {
+    return *this = *this / other;
+}
+
+inline BigNumber &BigNumber::operator%=(const BigNumber &other) {
+    return *this = *this % other;
+}
+
+inline BigNumber operator+(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big && ((b.small >= 0) ? (a.small <= LLONG_MAX - b.small) : (a.small >= LLONG_MIN - b.small)))
+        return BigNumber(a.small + b.small);
+    return BigNumber::add(a, b, false);
+}
+
+inline BigNumber operator-(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big && ((b.small >= 0) ? (a.small >= LLONG_MIN + b.small) : (a.small <= LLONG_MAX + b.small)))
+        return BigNumber(a.small - b.small);
+    return BigNumber::add(a, b, true);
+}
+
+inline BigNumber operator*(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big) {
+#if defined(_MSC_VER)
+        long long high;
+        long long low = _mul128(a.small, b.small, &high);
+        if (high == (low >> 63))
+            return BigNumber(low);
+#else
+        long long result;
+        if (!__builtin_mul_overflow(a.small, b.small, &result))
+            return BigNumber(result);
+#endif
+    }
+    return BigNumber::multiply(a, b);
+}
+
+inline BigNumber operator/(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big && ((a.small != LLONG_MIN) || (b.small != -1)))
+        return BigNumber(a.small / b.small);
+    return BigNumber::divide(a, b, false);
+}
+
+inline BigNumber operator%(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big)
+        return BigNumber((b.small != -1) ? a.small % b.small : 0);
+    return BigNumber::divide(a, b, true);
+}
+
+inline bool operator==(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big)
+        return a.small == b.small;
+    return BigNumber::compare(a, b) == 0;
+}
+
+inline bool operator<(const BigNumber &a, const BigNumber &b) {
+    if (!a.big && !b.big)
+        return a.small < b.small;
+    return BigNumber::compare(a, b) < 0;
+}
+
+inline bool operator!=(const BigNumber &a, const BigNumber &b) {
+    return !(a == b);
+}
+
+inline bool operator>(const BigNumber &a, const BigNumber &b) {
+    return b < a;
+}
+
+inline bool operator<=(const BigNumber &a, const BigNumber &b) {
+    return !(b < a);
+}
+
+inline bool operator>=(const BigNumber &a, const BigNumber &b) {
+    return !(a < b);
+}
@@ -0,0 +1,83 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "CompiledProgram.h"
+
+#include <string>
+
+CompiledProgram::CompiledProgram(const Definition &definition, TestManager::Test *test):
+Runtime     (test),
+stage       (definition.stage) {
+    grid.resize(definition.width, definition.height);
+    writeLog.resize(definition.width * definition.height);
+
+    const Literal *literal = definition.literals;
+    for (std::size_t i = 0; i < definition.width * definition.height; ++i) {
+        char ch = definition.layout[i];
+        Object object;
+
+        if (ch == ' ') {
+            continue;
+        } else if (ch == '#') {
+            object.type = Object::Type::Block;
+        } else if ((ch == 'I') || (ch == 'O') || (ch == '$') || (ch == '@') || ((ch >= '0') && (ch <= '9'))) {
+            object.type = Object::Type::Data;
+            if (ch == 'I') {
+                object.data.type = Data::Type::Input;
+            } else if (ch == 'O') {
+                object.data.type = Data::Type::Output;
+            } else if (ch == '@') {
+                object.data.type = Data::Type::String;
+                object.data.string = std::string(literal->text, literal->size);
+                ++literal;
+            } else if (ch == '$') {
+                object.data.type = Data::Type::Number;
+                fromString(std::string(literal->text, literal->size), object.data.number);
+                ++literal;
+            } else {
+                object.data.type = Data::Type::Number;
+                object.data.number = ch - '0';
+            }
+        } else if (std::string("-|+*><%!x").find(ch) != std::string::npos) {
+            object = Object::CreatePipe(ch);
+        } else {
+            object = Object::CreateOperator(ch);
+        }
+        grid.set(i, std::move(object));
+    }
+
+    pipeRoutes.build(grid);
+    for (std::size_t n = 0; n < definition.portCount; ++n)
+        entries.push_back(pipeRoutes.entry(definition.ports[n].cell, definition.ports[n].dir));
+    movement.reset(grid);
+}
+
+void CompiledProgram::firstStage() {
+    stage(*this);
+    writeLog.commit(grid);
+}
+
+void CompiledProgram::secondStage() {
+    if (grid.getDataCells().empty()) {
+        ended = true;
+        return;
+    }
+
+    movement.run(grid, Movement::Engine::Event);
+}
@@ -0,0 +1,133 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Data.h"
+#include "Object.h"
+#include "Operator.h"
+#include "Runtime.h"
+#include "TestManager.h"
+#include "Util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Runtime of the programs written by roopc (see Transpiler). It loads the grid of a program and runs
+// its ticks like the interpreter (see Runtime), but the first stage is a function written for the
+// program, which evaluates its operator cells one after the other, and the second stage is left to
+// Movement. The interpreter is not used, the generated programs are built with the sources of the
+// runtime listed in the README.
+class CompiledProgram : public Runtime {
+public:
+    using Stage = void (*)(CompiledProgram &program);
+
+    // A Number (in decimal) or a String.
+    struct Literal {
+        const char *text;
+        std::size_t size;
+    };
+    // Pipe or special operator into which a stage sends objects, in the given direction.
+    struct Port {
+        std::size_t cell;
+        util::Dir dir;
+    };
+    // What roopc writes for each program.
+    struct Definition {
+        std::size_t width;
+        std::size_t height;
+        // One character for each cell, border included, row after row: the ones of the source for
+        // blocks, pipes, operators, Input and Output, a digit for a Number of one digit, '$' for any
+        // other Number and '@' for a String, whose values are taken from literals in the same order.
+        const char *layout;
+        const Literal *literals;
+        // The stage refers to the routes of its ports by their position here.
+        const Port *ports;
+        std::size_t portCount;
+        Stage stage;
+    };
+
+    CompiledProgram(const Definition &definition, TestManager::Test *test = nullptr);
+
+    using Runtime::run;
+
+    // Used by the stages, which read the grid as it was at the start of the tick.
+    std::uint8_t kind(std::size_t i) const;
+    const Data &data(std::size_t i) const;
+    // Where the stages evaluate the rules.
+    Result &getResult();
+    // Place an outcome of a rule like the interpreter does, and return whether it was placed. land()
+    // is for the cells that can be empty, replace() for the outcomes of the operators that overwrite
+    // their neighbours, send() for pipes and special operators and nowhere() for the other static
+    // cells, where only an Empty outcome counts as placed.
+    bool land(Object &obj, std::size_t i);
+    bool replace(Object &obj, std::size_t i);
+    bool send(const Object &obj, std::size_t port);
+    bool nowhere(const Object &obj) const;
+    void clearLater(std::size_t i);
+private:
+    void firstStage() override;
+    void secondStage() override;
+
+    Stage stage;
+    // First step of the route of each port.
+    std::vector<std::uint32_t> entries;
+    Result result;
+};
+
+inline std::uint8_t CompiledProgram::kind(std::size_t i) const {
+    return grid.dataKind(i);
+}
+
+inline const Data &CompiledProgram::data(std::size_t i) const {
+    return grid.data(i);
+}
+
+inline Result &CompiledProgram::getResult() {
+    return result;
+}
+
+inline bool CompiledProgram::land(Object &obj, std::size_t i) {
+    if (obj.type == Object::Type::Empty)
+        return true;
+    if (writeLog.type(grid, i) != Object::Type::Empty)
+        return false;
+    writeLog.write(i, std::move(obj));
+    return true;
+}
+
+inline bool CompiledProgram::replace(Object &obj, std::size_t i) {
+    if (obj.type != Object::Type::Empty)
+        writeLog.write(i, std::move(obj));
+    return true;
+}
+
+inline bool CompiledProgram::send(const Object &obj, std::size_t port) {
+    return (obj.type == Object::Type::Empty) || pipeRoutes.send(grid, writeLog, obj, entries[port]);
+}
+
+inline bool CompiledProgram::nowhere(const Object &obj) const {
+    return obj.type == Object::Type::Empty;
+}
+
+inline void CompiledProgram::clearLater(std::size_t i) {
+    writeLog.clearLater(i);
+}
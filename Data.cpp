@@ -21,7 +21,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 std::string Data::toS() const {
     if (type == Type::String) {
-        return string;
+        return string.str();
     } else if (type == Type::Number) {
         return toString(number);
     } else {
@@ -39,7 +39,26 @@ bool Data::empty() const {
     }
 }
 
-bool Data::operator==(const Data &other) {
+util::Hash Data::hash() const {
+    std::uint64_t header = static_cast<std::uint64_t>(type) << 8 | static_cast<std::uint64_t>(direction);
+    util::Hash hash;
+    hash.first = util::mix(header);
+    hash.second = util::mixOther(header);
+
+    util::Hash contents;
+    if (type == Type::String)
+        contents = string.hash();
+    else if (type == Type::Number)
+        contents = hashNumber(number);
+    else
+        return hash;
+
+    hash.first = util::mix(hash.first ^ contents.first);
+    hash.second = util::mixOther(hash.second ^ contents.second);
+    return hash;
+}
+
+bool Data::operator==(const Data &other) const {
     if (type != other.type)
         return false;
 
@@ -20,13 +20,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #pragma once
 
 #include "Number.h"
+#include "SharedString.h"
 #include "Util.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <type_traits>
 
 class Data {
 public:
-    enum class Type {
+    enum class Type : std::uint8_t {
         None    = 0b0000,
         Number  = 0b0001,
         String  = 0b0010,
@@ -38,18 +41,36 @@ public:
 
     std::string toS() const;
     bool empty() const;
+    // Hash of the type, the direction and the field that operator== compares for the type.
+    util::Hash hash() const;
 
-    bool operator==(const Data &other);
+    bool operator==(const Data &other) const;
 
     Type type = Type::None;
-    Number number;
-    std::string string;
+    Number number{};
+    SharedString string;
     util::Dir direction = util::Dir::Right;
 private:
 
 };
 
-inline bool check(Data::Type a, Data::Type b) {
-    using uType = std::underlying_type<Data::Type>::type;
-    return (static_cast<uType>(a) & static_cast<uType>(b)) != 0;
+constexpr bool check(Data::Type a, Data::Type b) {
+    return (static_cast<std::underlying_type<Data::Type>::type>(a) & static_cast<std::underlying_type<Data::Type>::type>(b)) != 0;
+}
+
+// Small index of each type (None, Number, String, Input and Output) to build tables indexed by types.
+constexpr std::size_t dataKinds = 5;
+
+constexpr std::uint8_t kindOf(Data::Type type) {
+    return (type == Data::Type::Number) ? 1 :
+           (type == Data::Type::String) ? 2 :
+           (type == Data::Type::Input)  ? 3 :
+           (type == Data::Type::Output) ? 4 : 0;
+}
+
+constexpr Data::Type typeOfKind(std::size_t kind) {
+    return (kind == 1) ? Data::Type::Number :
+           (kind == 2) ? Data::Type::String :
+           (kind == 3) ? Data::Type::Input  :
+           (kind == 4) ? Data::Type::Output : Data::Type::None;
 }
@@ -0,0 +1,111 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "DataflowGraph.h"
+
+namespace {
+
+bool isStatic(Object::Type type) {
+    return (type != Object::Type::Empty) && (type != Object::Type::Data);
+}
+
+}
+
+void DataflowGraph::clear() {
+    nodes.clear();
+    first.clear();
+    edges.clear();
+    walls.clear();
+}
+
+void DataflowGraph::build(const Grid &grid, const PipeRoutes &routes) {
+    clear();
+
+    const std::size_t width = grid.getWidth();
+    const std::size_t cells = width * grid.getHeight();
+    const util::Dir dirs[] = {util::Dir::Up, util::Dir::Down, util::Dir::Left, util::Dir::Right};
+    auto towards = [&](std::size_t i, util::Dir dir) -> std::size_t {
+        switch (dir) {
+            case util::Dir::Up:     return i - width;
+            case util::Dir::Down:   return i + width;
+            case util::Dir::Left:   return i - 1;
+            default:                return i + 1;
+        }
+    };
+
+    // Node of the operator of each cell, only read for operator cells.
+    std::vector<std::uint32_t> nodeOf(cells);
+    for (std::size_t i = 0; i < cells; ++i) {
+        if (!check(grid.type(i), Object::Type::Operator))
+            continue;
+
+        Node node;
+        node.cell = static_cast<std::uint32_t>(i);
+        for (util::Dir dir : dirs)
+            node.routes[static_cast<std::size_t>(dir)] = routes.entry(towards(i, dir), dir);
+        nodeOf[i] = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back(node);
+    }
+
+    // The border is made of blocks, so the cells with neighbours are never on it.
+    first.resize(cells + 1);
+    walls.assign(cells, 0);
+    for (std::size_t i = 0; i < cells; ++i) {
+        first[i] = static_cast<std::uint32_t>(edges.size());
+        if (isStatic(grid.type(i)))
+            continue;
+
+        for (util::Dir dir : dirs) {
+            std::size_t neighbour = towards(i, dir);
+            if (isStatic(grid.type(neighbour)))
+                walls[i] |= 1 << static_cast<unsigned>(dir);
+            if (check(grid.type(neighbour), Object::Type::Operator))
+                edges.push_back(nodeOf[neighbour]);
+        }
+    }
+    first[cells] = static_cast<std::uint32_t>(edges.size());
+
+    activated.resize(nodes.size());
+}
+
+void DataflowGraph::activate(const std::vector<std::size_t> &cells, std::vector<std::uint32_t> &active) {
+    for (std::size_t i : cells) {
+        for (std::uint32_t e = first[i]; e < first[i + 1]; ++e)
+            activated.insert(edges[e]);
+    }
+
+    active.clear();
+    for (std::size_t node = activated.next(0); node != OrderedBitSet::none; node = activated.next(node + 1)) {
+        active.push_back(static_cast<std::uint32_t>(node));
+        activated.erase(node);
+    }
+}
+
+std::size_t DataflowGraph::getNodes() const {
+    return nodes.size();
+}
+
+std::size_t DataflowGraph::getEdges() const {
+    return edges.size();
+}
+
+std::size_t DataflowGraph::getMemoryUsage() const {
+    return nodes.capacity() * sizeof(Node) + (first.capacity() + edges.capacity()) * sizeof(std::uint32_t)
+         + walls.capacity();
+}
@@ -0,0 +1,80 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Grid.h"
+#include "OrderedBitSet.h"
+#include "PipeRoutes.h"
+#include "Util.h"
+
+#include <cstdint>
+#include <vector>
+
+// Adjacency cache of a program, built from the layout of the grid when it is loaded, that the
+// compiled engine (-c) looks up instead of the cells around each Data. It is not a dataflow engine:
+// the Data still move on the grid and the operators still read it every tick, the cache only saves
+// finding what is next to them. Operators, pipes and blocks never change, so it has:
+// - A node for each operator, with the cells next to it and the first step of the pipe route that
+//   an object it sends to each side takes (see PipeRoutes).
+// - The edges from each cell to the nodes it activates when it holds Data.
+// - The free-fall lanes: for each cell, the sides where a Data can never move because the
+//   neighbour is a static cell.
+class DataflowGraph {
+public:
+    void clear();
+    void build(const Grid &grid, const PipeRoutes &routes);
+
+    // Nodes next to the given cells, in the order of the grid.
+    void activate(const std::vector<std::size_t> &cells, std::vector<std::uint32_t> &active);
+    std::size_t cell(std::uint32_t node) const;
+    // First steps of the routes of the objects sent to each side of the node, indexed by util::Dir.
+    const std::uint32_t *routes(std::uint32_t node) const;
+    // The neighbour of the cell in the direction is a block, a pipe or an operator.
+    bool wall(std::size_t i, util::Dir dir) const;
+
+    std::size_t getNodes() const;
+    std::size_t getEdges() const;
+    std::size_t getMemoryUsage() const;
+private:
+    struct Node {
+        std::uint32_t cell;
+        std::uint32_t routes[4];
+    };
+
+    std::vector<Node> nodes;
+    // The nodes next to cell i are edges[first[i]] to edges[first[i + 1] - 1].
+    std::vector<std::uint32_t> first;
+    std::vector<std::uint32_t> edges;
+    OrderedBitSet activated;
+    // Bit 1 << dir of each cell is set if wall(i, dir).
+    std::vector<std::uint8_t> walls;
+};
+
+inline std::size_t DataflowGraph::cell(std::uint32_t node) const {
+    return nodes[node].cell;
+}
+
+inline const std::uint32_t *DataflowGraph::routes(std::uint32_t node) const {
+    return nodes[node].routes;
+}
+
+inline bool DataflowGraph::wall(std::size_t i, util::Dir dir) const {
+    return (walls[i] >> static_cast<unsigned>(dir)) & 1;
+}
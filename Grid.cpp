@@ -0,0 +1,236 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "Grid.h"
+
+#include <initializer_list>
+#include <utility>
+
+const Data Grid::noData = Data();
+
+void Grid::resize(std::size_t width, std::size_t height) {
+    this->width = width;
+    this->height = height;
+
+    types.assign(width * height, Object::Type::Empty);
+    ids.assign(width * height, 0);
+    kinds.assign(width * height, 0);
+    slots.assign(width * height, 0);
+    dataIndices.clear();
+    dataHashes.clear();
+    dataCells.clear();
+    pool.clear();
+    freeSlots.clear();
+
+    tilesPerRow = (width + tileSize - 1) / tileSize;
+    tiles.assign(tilesPerRow * ((height + tileSize - 1) / tileSize), Tile());
+    hash = util::Hash();
+}
+
+std::size_t Grid::getWidth() const {
+    return width;
+}
+
+std::size_t Grid::getHeight() const {
+    return height;
+}
+
+const std::vector<std::size_t> &Grid::getDataCells() const {
+    return dataCells;
+}
+
+util::Hash Grid::getHash() const {
+    return hash;
+}
+
+const std::vector<Grid::Tile> &Grid::getTiles() const {
+    return tiles;
+}
+
+std::size_t Grid::getMemoryUsage() const {
+    return types.capacity() * sizeof(Object::Type)
+         + ids.capacity() * sizeof(std::uint8_t)
+         + kinds.capacity() * sizeof(std::uint8_t)
+         + slots.capacity() * sizeof(std::uint32_t)
+         + dataIndices.capacity() * sizeof(std::uint32_t)
+         + dataHashes.capacity() * sizeof(util::Hash)
+         + dataCells.capacity() * sizeof(std::size_t)
+         + pool.capacity() * sizeof(Data)
+         + freeSlots.capacity() * sizeof(std::uint32_t)
+         + tiles.capacity() * sizeof(Tile);
+}
+
+Object Grid::get(std::size_t i) const {
+    Object obj;
+    obj.type = types[i];
+
+    if (check(obj.type, Object::Type::Operator))
+        obj.op = op(i);
+    else if (obj.type == Object::Type::Pipe)
+        obj.pipe.type = pipe(i);
+    else if (obj.type == Object::Type::Data)
+        obj.data = pool[slots[i]];
+
+    return obj;
+}
+
+void Grid::set(std::size_t i, const Object &obj) {
+    if (obj.type == Object::Type::Data)
+        setData(i, obj.data.hash(), obj.data.type) = obj.data;
+    else
+        setOther(i, obj);
+}
+
+void Grid::set(std::size_t i, Object &&obj) {
+    if (obj.type == Object::Type::Data)
+        setData(i, obj.data.hash(), obj.data.type) = std::move(obj.data);
+    else
+        setOther(i, obj);
+}
+
+void Grid::clear(std::size_t i) {
+    hash ^= cellHash(i);
+    releaseSlot(i);
+    count(i, -1);
+    types[i] = Object::Type::Empty;
+    kinds[i] = 0;
+}
+
+void Grid::move(std::size_t from, std::size_t to) {
+    hash ^= cellHash(from);
+    hash ^= cellHash(to);
+    releaseSlot(to);
+    count(to, -1);
+    count(from, -1);
+    types[to] = types[from];
+    kinds[to] = kinds[from];
+    slots[to] = slots[from];
+    dataCells[dataIndices[slots[to]]] = to;
+    types[from] = Object::Type::Empty;
+    kinds[from] = 0;
+    count(to, 1);
+    hash ^= cellHash(to);
+}
+
+// Turns the cell into Data with the given hash and type and returns the Data of its slot, which the
+// caller assigns. They are known beforehand so that the Data can be moved in after them.
+Data &Grid::setData(std::size_t i, const util::Hash &dataHash, Data::Type dataType) {
+    hash ^= cellHash(i);
+
+    if (types[i] != Object::Type::Data) {
+        count(i, -1);
+        slots[i] = allocateSlot();
+        dataIndices[slots[i]] = static_cast<std::uint32_t>(dataCells.size());
+        dataCells.push_back(i);
+        types[i] = Object::Type::Data;
+        count(i, 1);
+    }
+    dataHashes[slots[i]] = dataHash;
+    kinds[i] = kindOf(dataType);
+
+    hash ^= cellHash(i);
+    return pool[slots[i]];
+}
+
+void Grid::setOther(std::size_t i, const Object &obj) {
+    hash ^= cellHash(i);
+
+    releaseSlot(i);
+    count(i, -1);
+    types[i] = obj.type;
+    kinds[i] = 0;
+    count(i, 1);
+
+    if (check(obj.type, Object::Type::Operator)) {
+        ids[i] = static_cast<std::uint8_t>((static_cast<unsigned>(obj.op.code) << 1) | (obj.op.noRemove ? 1 : 0));
+    } else if (obj.type == Object::Type::Pipe) {
+        ids[i] = static_cast<std::uint8_t>(obj.pipe.type);
+    }
+
+    hash ^= cellHash(i);
+}
+
+std::uint32_t Grid::allocateSlot() {
+    if (freeSlots.empty()) {
+        pool.emplace_back();
+        dataIndices.push_back(0);
+        dataHashes.emplace_back();
+        return static_cast<std::uint32_t>(pool.size() - 1);
+    }
+
+    std::uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void Grid::releaseSlot(std::size_t i) {
+    if (types[i] == Object::Type::Data) {
+        std::uint32_t slot = slots[i];
+        pool[slot] = Data();
+        freeSlots.push_back(slot);
+
+        std::size_t last = dataCells.back();
+        dataCells[dataIndices[slot]] = last;
+        dataIndices[slots[last]] = dataIndices[slot];
+        dataCells.pop_back();
+    }
+}
+
+// Zobrist-style key of the contents of a cell at its position, the hash of the grid is the xor of
+// the keys of all the cells that are not empty. Each half of the key only uses the same half of the
+// hash of the Data.
+util::Hash Grid::cellHash(std::size_t i) const {
+    util::Hash contents;
+    switch (types[i]) {
+        case Object::Type::Empty:
+            return contents;
+        case Object::Type::Data:
+            contents = dataHashes[slots[i]];
+            break;
+        default:
+            contents.first = contents.second = static_cast<std::uint64_t>(types[i]) << 8 | ids[i];
+            break;
+    }
+
+    util::Hash key;
+    key.first = util::mix(util::mix(i) ^ contents.first);
+    key.second = util::mixOther(util::mixOther(i) ^ contents.second);
+    return key;
+}
+
+// Updates the summary of the tile of the cell for n (1 or -1) cells of its current type.
+void Grid::count(std::size_t i, int n) {
+    switch (types[i]) {
+        case Object::Type::Data:
+            tiles[tileIndex(i)].data += n;
+            break;
+        case Object::Type::NormalOperator:
+        case Object::Type::SpecialOperator:
+            if (n > 0) {
+                // Operators never disappear once the grid is loaded.
+                for (std::size_t neighbour : {i - width, i - 1, i + 1, i + width}) {
+                    if (neighbour < types.size())
+                        tiles[tileIndex(neighbour)].nearOperators = true;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Object.h"
+#include <cstdint>
+#include <vector>
+
+// Row-major grid stored as separate planes: one byte with the type of each cell, one byte with the
+// operator (code and noRemove bit) or pipe of the cell, and the slot of its Data in a side pool
+// (only used by Data cells), so a cell takes 7 bytes and only Data pays for a whole Data object.
+// Another byte keeps the kind of the Data of the cell (see kindOf), so that the types around an
+// operator are read from a single plane.
+// The grid is also divided in tiles of tileSize x tileSize cells that know how much Data they contain
+// and whether there are operators around them, so that the parts where nothing can change can be
+// skipped.
+class Grid {
+public:
+    static const std::size_t tileSize = 32;
+
+    struct Tile {
+        std::uint32_t data = 0;
+        // There are operators inside the tile or next to its border, which its data can activate.
+        bool nearOperators = false;
+    };
+
+    void resize(std::size_t width, std::size_t height);
+
+    std::size_t getWidth() const;
+    std::size_t getHeight() const;
+    std::size_t index(std::size_t x, std::size_t y) const;
+    // Cells that contain Data, in no particular order.
+    const std::vector<std::size_t> &getDataCells() const;
+
+    const std::vector<Tile> &getTiles() const;
+    std::size_t tileIndex(std::size_t i) const;
+    const Tile &getTile(std::size_t x, std::size_t y) const;
+    // Hash of the contents of the whole grid, updated on every change: the type of each cell, its
+    // operator or pipe, and its Data with its direction.
+    util::Hash getHash() const;
+    // Bytes reserved by the planes, the tiles and the Data pool (strings not stored inline excluded).
+    std::size_t getMemoryUsage() const;
+
+    Object::Type type(std::size_t i) const;
+    const Data &data(std::size_t i) const;
+    Operator op(std::size_t i) const;
+    Pipe::Type pipe(std::size_t i) const;
+    // kindOf the type of the Data of the cell, 0 if the cell is not Data.
+    std::uint8_t dataKind(std::size_t i) const;
+
+    Object get(std::size_t i) const;
+    void set(std::size_t i, const Object &obj);
+    // Same as set, but the Data is moved into the pool instead of sharing it with obj.
+    void set(std::size_t i, Object &&obj);
+    void clear(std::size_t i);
+    // Moves the Data from one cell to an empty one without copying it.
+    void move(std::size_t from, std::size_t to);
+private:
+    static const Data noData;
+
+    Data &setData(std::size_t i, const util::Hash &dataHash, Data::Type dataType);
+    void setOther(std::size_t i, const Object &obj);
+    std::uint32_t allocateSlot();
+    void releaseSlot(std::size_t i);
+    void count(std::size_t i, int n);
+    util::Hash cellHash(std::size_t i) const;
+
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::vector<Object::Type> types;
+    std::vector<std::uint8_t> ids;
+    std::vector<std::uint8_t> kinds;
+    std::vector<std::uint32_t> slots;
+    // For each slot of the pool, position of its cell in dataCells.
+    std::vector<std::uint32_t> dataIndices;
+    // For each slot of the pool, hash of its Data.
+    std::vector<util::Hash> dataHashes;
+    std::vector<std::size_t> dataCells;
+    std::vector<Data> pool;
+    std::vector<std::uint32_t> freeSlots;
+    std::size_t tilesPerRow = 0;
+    std::vector<Tile> tiles;
+    util::Hash hash;
+};
+
+inline std::size_t Grid::index(std::size_t x, std::size_t y) const {
+    return y * width + x;
+}
+
+inline std::size_t Grid::tileIndex(std::size_t i) const {
+    std::size_t y = i / width;
+    std::size_t x = i - y * width;
+    return (y / tileSize) * tilesPerRow + x / tileSize;
+}
+
+inline const Grid::Tile &Grid::getTile(std::size_t x, std::size_t y) const {
+    return tiles[(y / tileSize) * tilesPerRow + x / tileSize];
+}
+
+inline Object::Type Grid::type(std::size_t i) const {
+    return types[i];
+}
+
+inline const Data &Grid::data(std::size_t i) const {
+    return types[i] == Object::Type::Data ? pool[slots[i]] : noData;
+}
+
+inline Operator Grid::op(std::size_t i) const {
+    Operator op;
+    op.code = static_cast<Operator::Code>(ids[i] >> 1);
+    op.noRemove = (ids[i] & 1) != 0;
+    return op;
+}
+
+inline Pipe::Type Grid::pipe(std::size_t i) const {
+    return static_cast<Pipe::Type>(ids[i]);
+}
+
+inline std::uint8_t Grid::dataKind(std::size_t i) const {
+    return kinds[i];
+}
@@ -24,10 +24,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstring>
 #include <fstream>
+#include <initializer_list>
+#include <iomanip>
 #include <iostream>
 #include <limits>
-#include <sstream>
 #include <utility>
 
 namespace {
@@ -76,13 +78,17 @@ Object getConstant(const std::string &s) {
     if (s == "ul")  {object.data.string = upperLetters;   return object;}
     if (s == "al")  {object.data.string = allLetters;     return object;}
     if (s == "aa") {
+        std::string chars;
         for (unsigned char c = 0;  c <= 127; ++c)
-            object.data.string += c;
+            chars += c;
+        object.data.string = std::move(chars);
         return object;
     }
     if (s == "pa") {
+        std::string chars;
         for (unsigned char c = 32; c <= 126; ++c)
-            object.data.string += c;
+            chars += c;
+        object.data.string = std::move(chars);
         return object;
     }
     if (s == "dd")  {object.data.string = digits;         return object;}
@@ -97,8 +103,9 @@ Object getConstant(const std::string &s) {
 
     object.data.type = Data::Type::Number;
 
-    if (s == "min") {object.data.number = std::numeric_limits<Number>::min(); return object;}
-    if (s == "max") {object.data.number = std::numeric_limits<Number>::max(); return object;}
+    // The limits of 64-bit numbers, also when numbers have no limits.
+    if (s == "min") {object.data.number = std::numeric_limits<long long>::min(); return object;}
+    if (s == "max") {object.data.number = std::numeric_limits<long long>::max(); return object;}
 
     bool allDigits = true;
     Number n = 0;
@@ -114,273 +121,146 @@ Object getConstant(const std::string &s) {
     if (allDigits) {
         n %= 128;
         object.data.type = Data::Type::String;
-        object.data.string += static_cast<char>(n);
+        object.data.string = std::string(1, static_cast<char>(n));
         return object;
     }
 
     return Object();
 }
 
-// Forward declaration so that placeObject can use it. Both functions can be called mutually.
-// It is undefined behavior if the loop is infinite (it will probably fill the stack).
-bool sendObject(Grid &, const Object &, std::size_t, std::size_t, util::Dir);
+// Signature of the kinds of the data around an operator (see Operator::signatures).
+std::size_t signature(const Grid &grid, std::size_t i) {
+    const std::size_t width = grid.getWidth();
+    return grid.dataKind(i - width) + (grid.dataKind(i - 1) + (grid.dataKind(i + 1) + grid.dataKind(i + width) * dataKinds) * dataKinds) * dataKinds;
+}
 
 // Try to place an object in a free space or send it through a pipe. Return true on success.
-bool placeObject(Grid &grid, const Object &obj, std::size_t x, std::size_t y, util::Dir dir, bool force = false) {
-    Object::Type type = grid[y][x].type;
+// The grid is only read, the changes are recorded in the log.
+// The object is moved into the log if it lands, it only goes on as a copy through pipes.
+// entries are the first steps of the routes of the operator in each direction, if they are known.
+bool placeObject(const Grid &grid, WriteLog &log, PipeRoutes &routes, Object &&obj, std::size_t x, std::size_t y, util::Dir dir, bool force, const std::uint32_t *entries) {
+    std::size_t i = grid.index(x, y);
+    Object::Type type = log.type(grid, i);
 
     if (obj.type == Object::Type::Empty) {
         return true;
     }
 
     if (force || (type == Object::Type::Empty)) {
-        grid[y][x] = obj;
+        log.write(i, std::move(obj));
         return true;
     } else if ((type == Object::Type::Pipe) || (type == Object::Type::SpecialOperator)) {
-        return sendObject(grid, obj, x, y, dir);
+        if (entries != nullptr)
+            return routes.send(grid, log, obj, entries[static_cast<std::size_t>(dir)]);
+        return routes.send(grid, log, obj, i, dir);
     }
 
     return false;
 }
 
-bool sendObject(Grid &grid, const Object &obj, std::size_t x, std::size_t y, util::Dir dir) {
-    Object::Type type = grid[y][x].type;
+}
 
-    if (type == Object::Type::SpecialOperator) {
-        Result result = grid[y][x].op.processFromPipe(obj);
-        if (result.success) {
-            return placeObject(grid, result.down, x, y + 1, util::Dir::Down);
-        } else {
-            return false;
-        }
-    } else if (type == Object::Type::Pipe) {
-        switch (grid[y][x].pipe.type) {
-            case Pipe::Type::Horizontal:
-                if (dir == util::Dir::Left) {
-                    return sendObject(grid, obj, x - 1, y, dir);
-                } else {
-                    dir = util::Dir::Right;
-                    return sendObject(grid, obj, x + 1, y, dir);
-                }
-            case Pipe::Type::Vertical:
-                if (dir == util::Dir::Up) {
-                    return sendObject(grid, obj, x, y - 1, dir);
-                } else {
-                    dir = util::Dir::Down;
-                    return sendObject(grid, obj, x, y + 1, dir);
-                }
-            case Pipe::Type::Intersection:
-                if (dir == util::Dir::Up)
-                    return sendObject(grid, obj, x, y - 1, dir);
-                else if (dir == util::Dir::Left)
-                    return sendObject(grid, obj, x - 1, y, dir);
-                else if (dir == util::Dir::Right)
-                    return sendObject(grid, obj, x + 1, y, dir);
-                else
-                    return sendObject(grid, obj, x, y + 1, dir);
-            case Pipe::Type::Bouncer:
-                dir = util::invert(dir);
-                if (dir == util::Dir::Up)
-                    return sendObject(grid, obj, x, y - 1, dir);
-                else if (dir == util::Dir::Left)
-                    return sendObject(grid, obj, x - 1, y, dir);
-                else if (dir == util::Dir::Right)
-                    return sendObject(grid, obj, x + 1, y, dir);
-                else
-                    return sendObject(grid, obj, x, y + 1, dir);
-            case Pipe::Type::TurnR:
-                if (dir == util::Dir::Up)
-                    return sendObject(grid, obj, x + 1, y, util::Dir::Right);
-                else if (dir == util::Dir::Left)
-                    return sendObject(grid, obj, x, y - 1, util::Dir::Up);
-                else if (dir == util::Dir::Right)
-                    return sendObject(grid, obj, x, y + 1, util::Dir::Down);
-                else
-                    return sendObject(grid, obj, x - 1, y, util::Dir::Left);
-            case Pipe::Type::TurnL:
-                if (dir == util::Dir::Up)
-                    return sendObject(grid, obj, x - 1, y, util::Dir::Left);
-                else if (dir == util::Dir::Left)
-                    return sendObject(grid, obj, x, y + 1, util::Dir::Down);
-                else if (dir == util::Dir::Right)
-                    return sendObject(grid, obj, x, y - 1, util::Dir::Up);
-                else
-                    return sendObject(grid, obj, x + 1, y, util::Dir::Right);
-            case Pipe::Type::Duplicator:
-                if ((dir == util::Dir::Up) || (dir == util::Dir::Down)) {
-                    bool success = sendObject(grid, obj, x + 1, y, util::Dir::Right);
-                    success = sendObject(grid, obj, x - 1, y, util::Dir::Left) || success;
-                    return success;
-                } else {
-                    bool success = sendObject(grid, obj, x, y - 1, util::Dir::Up);
-                    success = sendObject(grid, obj, x, y + 1, util::Dir::Down) || success;
-                    return success;
-                }
-            case Pipe::Type::Teleport: {
-                bool found = false;
-                while (true) {
-                    if (dir == util::Dir::Up)
-                        --y;
-                    else if (dir == util::Dir::Left)
-                        --x;
-                    else if (dir == util::Dir::Right)
-                        ++x;
-                    else
-                        ++y;
-
-                    if (found) {
-                        return sendObject(grid, obj, x, y, dir);
-                    }
 
-                    if ((y == 0) || (x == 0) || (y == grid.size() - 1) || (x == grid[y].size() - 1)) {
-                        return false;
-                    } else if (grid[y][x].type == Object::Type::Pipe) {
-                        if (grid[y][x].pipe.type == Pipe::Type::Teleport) {
-                            found = true;
-                        }
-                    }
-                }
-            }
-            case Pipe::Type::Eraser:
-                return true;
-        }
-    }
 
-    return false;
-}
+Interpreter::Interpreter(const Options &options, TestManager::Test *test):
+Runtime     (test),
+options     (options) {
+    detectCycles = !options.debug;
 
+    if (options.threads > 1)
+        threadPool.reset(new ThreadPool(options.threads));
 }
 
+bool Interpreter::load(const char *text, std::size_t size) {
+    source.text = text;
+    source.lines.clear();
+    source.lines.push_back(0);
 
+    std::size_t longer = 0;
+    for (const char *end = text + size, *line = text; ; ) {
+        const char *newLine = (line < end) ? static_cast<const char *>(std::memchr(line, '\n', end - line)) : nullptr;
+        const char *lineEnd = newLine ? newLine : end;
 
-Interpreter::Interpreter(bool debugMode, TestManager::Test *test):
-tick        (0),
-ended       (false),
-printAll    (false),
-debugMode   (debugMode),
-testMode    (test != nullptr),
-test        (test),
-randomEngine(std::chrono::high_resolution_clock::now().time_since_epoch().count()) {
-    Operator::interpreter = this;
-}
+        if (static_cast<std::size_t>(lineEnd - line) > longer)
+            longer = lineEnd - line;
 
-std::string Interpreter::getInputString() {
-    std::string result;
-    std::getline(std::cin, result);
-    return result;
-}
+        source.lines.push_back(lineEnd - text + 1);
 
-Number Interpreter::getInputNumber() {
-    Number result;
-    std::string tmp;
-    bool exit = false;
-    do {
-        std::getline(std::cin, tmp);
-        std::stringstream ss(tmp);
-        exit = static_cast<bool>(ss >> result);
-    } while (!exit);
-
-    return result;
-}
+        if (!newLine)
+            break;
+        line = newLine + 1;
+    }
 
-void Interpreter::output(const std::string &s) {
-    std::cout << s;
-}
+    // The lines are surrounded by a border of blocks.
+    source.width = longer + 2;
+    source.height = source.lines.size() + 1;
+    source.consumed.assign(source.width * source.height, false);
 
-void Interpreter::output(Number n) {
-    std::cout << toString(n);
+    bool parsed = parse();
+    source = Source();
+    return parsed;
 }
 
-void Interpreter::halt(bool print) {
-    ended = true;
-    printAll = print;
-}
+char Interpreter::getSourceChar(std::size_t x, std::size_t y) const {
+    if (y == 0 || y == source.height - 1 || x == 0 || x == source.width - 1)
+        return '#';
 
-Number Interpreter::rand(Number n) {
-    if (n > 0) {
-        return std::uniform_int_distribution<Number>{0, n - 1}(randomEngine);
-    } else if (n < 0) {
-        return -std::uniform_int_distribution<Number>{0, -n - 1}(randomEngine);
-    } else {
-        Number mult = std::uniform_int_distribution<Number>{0, 1}(randomEngine) ? 1: -1;
-        return mult * std::uniform_int_distribution<Number>{}(randomEngine);
-    }
-}
+    if (source.consumed[y * source.width + x])
+        return ' ';
 
-bool Interpreter::load(std::stringstream &stream) {
-    gridSource.push_back(std::string());
+    std::size_t start = source.lines[y - 1];
+    std::size_t length = source.lines[y] - 1 - start;
+    return (x - 1 < length) ? source.text[start + x - 1] : ' ';
+}
 
-    std::string line;
-    std::size_t longer = 0;
-    while (std::getline(stream, line)) {
-        gridSource.push_back(std::string("#" + line));
-        if (gridSource.back().size() > longer)
-            longer = gridSource.back().size();
-    }
+bool Interpreter::execute() {
+    auto startTime = std::chrono::steady_clock::now();
+    std::size_t startAllocations = util::getAllocationCount();
 
-    gridSource[0] = std::string(longer + 1, '#');
+    run();
 
-    for (std::size_t i = 1; i < gridSource.size(); ++i) {
-        gridSource[i].resize(longer, ' ');
-        gridSource[i].push_back('#');
+    if (options.profile) {
+        profile.time = std::chrono::steady_clock::now() - startTime;
+        profile.allocations = util::getAllocationCount() - startAllocations;
+        printProfile();
     }
 
-    gridSource.push_back(std::string(longer + 1, '#'));
-
-    return parse();
+    return true;
 }
 
-bool Interpreter::execute() {
-    while (!ended) {
-        if (debugMode)
-            printDebug();
-
-        firstStage();
-
-        if (testMode) {
-            if (test->tick == tick) {
-                if (test->type == grid[test->y][test->x].data.type) {
-                    switch (test->type) {
-                        case Data::Type::Number:
-                            test->success = test->number == grid[test->y][test->x].data.number;
-                            break;
-                        case Data::Type::String:
-                            test->success = test->string == grid[test->y][test->x].data.string;
-                            break;
-                        default:
-                            test->success = true;
-                            break;
-                    }
-                }
-                ended = true;
-            }
-        }
+void Interpreter::beginTick() {
+    if (options.debug)
+        printDebug();
 
-        if (ended) {
-            if (printAll)
-                printAllObject();
-            break;
-        }
+    profile.tickStartAllocations = util::getAllocationCount();
+}
 
-        secondStage();
-        ++tick;
+void Interpreter::endTick() {
+    std::size_t tickAllocations = util::getAllocationCount() - profile.tickStartAllocations;
+    if (tickAllocations != 0) {
+        ++profile.allocatingTicks;
+        profile.lastAllocatingTick = tick;
+        if (tickAllocations > profile.maxTickAllocations) {
+            profile.maxTickAllocations = tickAllocations;
+            profile.maxAllocationsTick = tick;
+        }
     }
-
-    return true;
 }
 
 bool Interpreter::parse() {
-    for (std::size_t y = 0; y < gridSource.size(); ++y) {
-        std::string &line = gridSource[y];
-        grid.push_back(std::vector<Object>());
+    grid.resize(source.width, source.height);
+    writeLog.resize(source.width * source.height);
 
-        for (std::size_t x = 0; x < line.size(); ++x) {
-            char ch = line[x];
+    for (std::size_t y = 0; y < source.height; ++y) {
+        for (std::size_t x = 0; x < source.width; ++x) {
+            char ch = getSourceChar(x, y);
             Object object;
 
-            if (ch == ' ') {
-                object.type = Object::Type::Empty;
-            } else if (ch == '#') {
+            // The grid starts empty.
+            if (ch == ' ')
+                continue;
+
+            if (ch == '#') {
                 object.type = Object::Type::Block;
             } else if (ch == 'I') {
                 object.type = Object::Type::Data;
@@ -405,10 +285,15 @@ bool Interpreter::parse() {
             if (ended) {
                 return false;
             }
-            grid.back().push_back(object);
+            grid.set(grid.index(x, y), object);
         }
     }
 
+    pipeRoutes.build(grid);
+    if (options.compiled)
+        graph.build(grid, pipeRoutes);
+    movement.reset(grid, options.compiled ? &graph : nullptr);
+
     return true;
 }
 
@@ -445,15 +330,15 @@ Object Interpreter::parseLiteral(char ch, std::size_t startX, std::size_t startY
             ++y;
         }
 
-        if ((y == gridSource.size() - 1) || (x == gridSource[y].size() - 1)) {
+        if ((y == source.height - 1) || (x == source.width - 1)) {
             std::cout << "ERROR: unclosed literal (" << startX << ", " << startY << ")\n";
             end = true;
             ended = true;
             continue;
         }
 
-        char ch = gridSource[y][x];
-        gridSource[y][x] = ' ';
+        char ch = getSourceChar(x, y);
+        source.consumed[y * source.width + x] = true;
 
         if (!escaped && (ch == chEnd)) {
             end = true;
@@ -519,309 +404,198 @@ Object Interpreter::parseLiteral(char ch, std::size_t startX, std::size_t startY
     return object;
 }
 
+// Only the operators next to some data can do something. They are applied in the order of the grid,
+// because an operator can take the place of the results of the following ones.
+void Interpreter::findActiveOperators() {
+    const std::size_t width = grid.getWidth();
+    activeOperators.clear();
+    for (std::size_t i : grid.getDataCells()) {
+        if (!grid.getTiles()[grid.tileIndex(i)].nearOperators)
+            continue;
+
+        for (std::size_t neighbour : {i - width, i - 1, i + 1, i + width}) {
+            if (check(grid.type(neighbour), Object::Type::Operator))
+                activeOperators.push_back(neighbour);
+        }
+    }
+    std::sort(activeOperators.begin(), activeOperators.end());
+    activeOperators.erase(std::unique(activeOperators.begin(), activeOperators.end()), activeOperators.end());
+}
+
 void Interpreter::firstStage() {
-    using PersistGrid = std::vector<std::vector<bool>>;
-    PersistGrid persistGrid(grid.size(), std::vector<bool>(grid.back().size(), true));
+    if (options.compiled) {
+        graph.activate(grid.getDataCells(), activeNodes);
+        activeOperators.resize(activeNodes.size());
+        for (std::size_t n = 0; n < activeNodes.size(); ++n)
+            activeOperators[n] = graph.cell(activeNodes[n]);
+    } else {
+        findActiveOperators();
+    }
 
-    Grid newGrid = grid;
+    if (evaluations.size() < activeOperators.size())
+        evaluations.resize(activeOperators.size());
 
-    auto conformsType = [](const Object &obj, Data::Type type) -> bool {
-        if (type == Data::Type::None)
-            return true;
-        if (obj.type != Object::Type::Data)
-            return false;
-        if (check(type, obj.data.type))
-            return true;
+    // The grid does not change until the commit, so the pure operators can be evaluated in any order
+    // and only applying their results has to follow the order of the grid.
+    auto evaluatePure = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+            if (grid.op(activeOperators[n]).getDescriptor().pure)
+                evaluate(activeOperators[n], evaluations[n]);
+        }
+    };
+    std::chrono::steady_clock::time_point evaluationStart;
+    if (options.profile)
+        evaluationStart = std::chrono::steady_clock::now();
+    if (threadPool)
+        threadPool->run(activeOperators.size(), evaluatePure);
+    else
+        evaluatePure(0, activeOperators.size());
+    if (options.profile)
+        profile.evaluationTime += std::chrono::steady_clock::now() - evaluationStart;
+
+    for (std::size_t n = 0; n < activeOperators.size(); ++n) {
+        std::size_t i = activeOperators[n];
+        if (!grid.op(i).getDescriptor().pure)
+            evaluate(i, evaluations[n]);
+        else if (options.profile)
+            ++profile.pureEvaluations;
+        apply(i, evaluations[n], options.compiled ? graph.routes(activeNodes[n]) : nullptr);
+    }
 
-        return false;
+    writeLog.commit(grid);
+}
+
+void Interpreter::evaluate(std::size_t i, Evaluation &evaluation) const {
+    const std::size_t width = grid.getWidth();
+    std::size_t iU = i - width;
+    std::size_t iL = i - 1;
+    std::size_t iR = i + 1;
+    std::size_t iD = i + width;
+
+    auto add = [&](std::size_t rule, Evaluation::Axis axis) -> Result & {
+        Evaluation::Match &match = evaluation.matches[evaluation.count++];
+        match.rule = rule;
+        match.axis = axis;
+        return match.result;
     };
 
+    const Operator op = grid.op(i);
+    const Operator::Descriptor &desc = op.getDescriptor();
+    evaluation.count = 0;
+
+    if (desc.separateAxes) {
+        std::size_t vertical = desc.rules[grid.dataKind(iU) + grid.dataKind(iD) * dataKinds];
+        std::size_t horizontal = desc.rules[grid.dataKind(iL) + grid.dataKind(iR) * dataKinds];
+
+        // The matches follow the order of their rules, vertical first for the same rule.
+        if ((vertical != Operator::noRule) && (vertical <= horizontal))
+            op.processAxis(vertical, add(vertical, Evaluation::Axis::Vertical), grid.data(iU), grid.data(iD));
+        if (horizontal != Operator::noRule)
+            op.processAxis(horizontal, add(horizontal, Evaluation::Axis::Horizontal), grid.data(iL), grid.data(iR));
+        if ((vertical != Operator::noRule) && (vertical > horizontal))
+            op.processAxis(vertical, add(vertical, Evaluation::Axis::Vertical), grid.data(iU), grid.data(iD));
+    } else {
+        std::size_t rule = desc.rules[signature(grid, i)];
+        if (rule != Operator::noRule)
+            op.processAll(rule, add(rule, Evaluation::Axis::Both), grid.data(iU), grid.data(iL), grid.data(iR));
+    }
+}
+
+void Interpreter::apply(std::size_t i, Evaluation &evaluation, const std::uint32_t *routes) {
     auto RemovePersistentFlag = [&](Data::Type type, std::size_t x, std::size_t y) {
         if (type != Data::Type::None) {
-            persistGrid[y][x] = false;
+            writeLog.clearLater(grid.index(x, y));
         }
     };
 
-    auto allNone = [](Operator::DataOutcome &out) -> bool {
+    auto allNone = [](const Operator::DataOutcome &out) -> bool {
         return (out.up == Data::Type::None) && (out.left == Data::Type::None) && (out.right == Data::Type::None) && (out.down == Data::Type::None);
     };
 
-    for (std::size_t y = 1; y < grid.size() - 1; ++y) {
-        auto &line = grid[y];
-        for (std::size_t x = 1; x < line.size() - 1; ++x) {
-            Object &object = line[x];
-
-            Object &objU = grid[y - 1][x];
-            Object &objL = grid[y][x - 1];
-            Object &objR = grid[y][x + 1];
-            Object &objD = grid[y + 1][x];
-
-            if ((objU.type != Object::Type::Data) && (objL.type != Object::Type::Data) &&
-                (objR.type != Object::Type::Data) && (objD.type != Object::Type::Data)) {
-                    continue;
-            }
-
-            if (check(object.type, Object::Type::Operator)) {
-                bool verticalAlreadyChecked = false;
-                bool horizontalAlreadyChecked = false;
-                for (std::size_t n = 0; n < object.op.io.size(); ++n) {
-                    Operator::DataRequirements &req = object.op.io[n].req;
-                    Operator::DataOutcome &out = object.op.io[n].out;
-
-                    bool conforms;
-                    bool vertical = false;
-                    bool horizontal = false;
-                    if (object.op.separateAxes) {
-                        if (!verticalAlreadyChecked)
-                            vertical   = conformsType(objU, req.up) && conformsType(objD, req.down);
-                        if (!horizontalAlreadyChecked)
-                            horizontal = conformsType(objL, req.up) && conformsType(objR, req.down);
-                        conforms = vertical || horizontal;
-                    } else {
-                        conforms = conformsType(objU, req.up) && conformsType(objL, req.left) &&
-                                   conformsType(objD, req.down) && conformsType(objR, req.right);
-                    }
-
-                    if (!conforms)
-                        continue;
-
-                    bool placed = false;
-                    bool placedV = false;
-                    bool placedH = false;
-
-                    if (object.op.separateAxes) {
-                        if (vertical) {
-                            Result result = object.op.processAxis(n, objU, objD);
-                            if (result.success) {
-                                if (allNone(out)) {
-                                    placedV = true;
-                                } else {
-                                    if ((out.up != Data::Type::None) && placeObject(newGrid, result.first, x, y - 1, util::Dir::Up, object.op.replace))
-                                        placedV = true;
-                                    if ((out.down != Data::Type::None) && placeObject(newGrid, result.second, x, y + 1, util::Dir::Down, object.op.replace) )
-                                        placedV = true;
-                                }
-                            }
-                        }
-                        if (horizontal) {
-                            Result result = object.op.processAxis(n, objL, objR);
-                            if (result.success) {
-                                if (allNone(out)) {
-                                    placedH = true;
-                                } else {
-                                    if ((out.up != Data::Type::None) && placeObject(newGrid, result.first, x - 1, y, util::Dir::Left, object.op.replace))
-                                        placedH = true;
-                                    if ((out.down != Data::Type::None) && placeObject(newGrid, result.second, x + 1, y, util::Dir::Right, object.op.replace))
-                                        placedH = true;
-                                }
-                            }
-                        }
-                    } else {
-                        Result result = object.op.processAll(n, objU, objL, objR, objD);
-                        if (result.success) {
-                            if (allNone(out)) {
-                                placed = true;
-                            } else {
-                                if ((out.up != Data::Type::None) && placeObject(newGrid, result.up, x, y - 1, util::Dir::Up, object.op.replace))
-                                    placed = true;
-                                if ((out.left != Data::Type::None) && placeObject(newGrid, result.left, x - 1, y, util::Dir::Left, object.op.replace))
-                                    placed = true;
-                                if ((out.right != Data::Type::None) && placeObject(newGrid, result.right, x + 1, y, util::Dir::Right, object.op.replace))
-                                    placed = true;
-                                if ((out.down != Data::Type::None) && placeObject(newGrid, result.down, x, y + 1, util::Dir::Down, object.op.replace))
-                                    placed = true;
-                            }
-                        }
-                    }
+    const std::size_t width = grid.getWidth();
+    std::size_t x = i % width;
+    std::size_t y = i / width;
 
-                    if (!object.op.noRemove) {
-                        if (object.op.separateAxes) {
-                            if (placedV) {
-                                RemovePersistentFlag(req.up,    x,     y - 1);
-                                RemovePersistentFlag(req.down,  x,     y + 1);
-                            }
-                            if (placedH) {
-                                RemovePersistentFlag(req.up,    x - 1, y);
-                                RemovePersistentFlag(req.down,  x + 1, y);
-                            }
-                        } else {
-                            if (placed) {
-                                RemovePersistentFlag(req.up,    x,     y - 1);
-                                RemovePersistentFlag(req.down,  x,     y + 1);
-                                RemovePersistentFlag(req.left,  x - 1, y);
-                                RemovePersistentFlag(req.right, x + 1, y);
-                            }
-                        }
-                    }
+    const Operator op = grid.op(i);
+    const Operator::Descriptor &desc = op.getDescriptor();
+    for (std::size_t m = 0; m < evaluation.count; ++m) {
+        Evaluation::Match &match = evaluation.matches[m];
+        const Operator::DataRequirements &req = desc.io[match.rule].req;
+        const Operator::DataOutcome &out = desc.io[match.rule].out;
+        Result &result = match.result;
 
-                    if (object.op.separateAxes) {
-                        if (vertical)
-                            verticalAlreadyChecked = true;
-                        if (horizontal)
-                            horizontalAlreadyChecked = true;
-                        if (verticalAlreadyChecked && horizontalAlreadyChecked) {
-                            break;
-                        } else {
-                            continue;
-                        }
-                    } else {
-                        break;
-                    }
-                }
+        bool placed = false;
+        if (result.success) {
+            if (allNone(out)) {
+                placed = true;
+            } else if (match.axis == Evaluation::Axis::Vertical) {
+                if ((out.up != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.first), x, y - 1, util::Dir::Up, desc.replace, routes))
+                    placed = true;
+                if ((out.down != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.second), x, y + 1, util::Dir::Down, desc.replace, routes))
+                    placed = true;
+            } else if (match.axis == Evaluation::Axis::Horizontal) {
+                if ((out.up != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.first), x - 1, y, util::Dir::Left, desc.replace, routes))
+                    placed = true;
+                if ((out.down != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.second), x + 1, y, util::Dir::Right, desc.replace, routes))
+                    placed = true;
+            } else {
+                if ((out.up != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.up), x, y - 1, util::Dir::Up, desc.replace, routes))
+                    placed = true;
+                if ((out.left != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.left), x - 1, y, util::Dir::Left, desc.replace, routes))
+                    placed = true;
+                if ((out.right != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.right), x + 1, y, util::Dir::Right, desc.replace, routes))
+                    placed = true;
+                if ((out.down != Data::Type::None) && placeObject(grid, writeLog, pipeRoutes, std::move(result.down), x, y + 1, util::Dir::Down, desc.replace, routes))
+                    placed = true;
             }
         }
-    }
 
-    for (std::size_t y = 1; y < newGrid.size() - 1; ++y) {
-        auto &line = newGrid[y];
-        for (std::size_t x = 1; x < line.size() - 1; ++x) {
-            Object &object = line[x];
-            if (!persistGrid[y][x]) {
-                object.clear();
-            }
+        if (!placed || op.noRemove)
+            continue;
+
+        if (match.axis == Evaluation::Axis::Vertical) {
+            RemovePersistentFlag(req.up,    x,     y - 1);
+            RemovePersistentFlag(req.down,  x,     y + 1);
+        } else if (match.axis == Evaluation::Axis::Horizontal) {
+            RemovePersistentFlag(req.up,    x - 1, y);
+            RemovePersistentFlag(req.down,  x + 1, y);
+        } else {
+            RemovePersistentFlag(req.up,    x,     y - 1);
+            RemovePersistentFlag(req.down,  x,     y + 1);
+            RemovePersistentFlag(req.left,  x - 1, y);
+            RemovePersistentFlag(req.right, x + 1, y);
         }
     }
-
-    grid = std::move(newGrid);
 }
 
 void Interpreter::secondStage() {
-    struct State {
-        bool fixed;
-        bool empty;
-        util::Dir direction;
-        int attemptsToOccupy = 0;
-    };
-
-    std::vector<std::vector<State>> stateGrid(grid.size(), std::vector<State>(grid.back().size()));
-
-    bool existData = false;
-
-    for (std::size_t y = 0; y < grid.size(); ++y) {
-        auto &line = grid[y];
-        for (std::size_t x = 0; x < line.size(); ++x) {
-            Object &object = line[x];
-            State &state = stateGrid[y][x];
-            if (object.type == Object::Type::Data) {
-                existData = true;
-                state.fixed = false;
-                state.empty = false;
-                state.direction = util::Dir::Down;
-                ++stateGrid[y + 1][x].attemptsToOccupy;
-                if (object.data.direction == util::Dir::Left)
-                    ++stateGrid[y][x - 1].attemptsToOccupy;
-                else
-                    ++stateGrid[y][x + 1].attemptsToOccupy;
-            } else if (object.type == Object::Type::Empty) {
-                state.fixed = false;
-                state.empty = true;
-            } else {
-                state.fixed = true;
-                state.empty = false;
-            }
-        }
-    }
-
-    if (!existData) {
+    if (grid.getDataCells().empty()) {
         ended = true;
         return;
     }
 
-    auto moveObject = [&](std::size_t fromX, std::size_t fromY, std::size_t toX, std::size_t toY) {
-        grid[toY][toX] = grid[fromY][fromX];
-        stateGrid[toY][toX].fixed = true;
-        stateGrid[toY][toX].empty = false;
-        grid[fromY][fromX].clear();
-        stateGrid[fromY][fromX].fixed = false;
-        stateGrid[fromY][fromX].empty = true;
-    };
-
-    bool toMove = true;
-    while (toMove) {
-        start:
-        toMove = false;
-
-        for (std::size_t y = 1; y < grid.size() - 1; ++y) {
-            auto &line = grid[y];
-            for (std::size_t x = 1; x < line.size() - 1; ++x) {
-                Object &object = line[x];
-                State &state = stateGrid[y][x];
-
-                if (state.fixed || state.empty)
-                    continue;
-
-                toMove = true;
-
-                std::size_t newX, newY;
-                switch (state.direction) {
-                    case util::Dir::Up:     newX = x; newY = y - 1; break;
-                    case util::Dir::Down:   newX = x; newY = y + 1; break;
-                    case util::Dir::Left:   newX = x - 1; newY = y; break;
-                    case util::Dir::Right:  newX = x + 1; newY = y; break;
-                    default: assert(false); abort();
-                }
-
-                State &newState = stateGrid[newY][newX];
-                if (newState.empty) {
-                    moveObject(x, y, newX, newY);
-                    --newState.attemptsToOccupy;
-                    if (state.attemptsToOccupy > 1)
-                        goto start;
-                } else if (newState.fixed) {
-                    if (state.direction == util::Dir::Down)
-                        state.direction = object.data.direction;
-                    else
-                        state.fixed = true;
-                    --newState.attemptsToOccupy;
-                } else if (state.direction == util::invert(newState.direction)) {
-                    state.fixed = true;
-                    --newState.attemptsToOccupy;
-                }
-            }
-        }
-    }
-}
-
-void Interpreter::printAllObject() {
-    for (std::size_t y = 1; y < grid.size() - 1; ++y) {
-        auto &line = grid[y];
-        for (std::size_t x = 1; x < line.size() - 1; ++x) {
-            Object &object = line[x];
-            if (object.type == Object::Type::Data) {
-                if (object.data.type == Data::Type::Number) {
-                    output(object.data.number);
-                } else if (object.data.type == Data::Type::String) {
-                    output(object.data.string);
-                } else {
-                    continue;
-                }
-                std::cout << ' ';
-            }
-        }
-    }
+    movement.run(grid, options.compiled ? Movement::Engine::Lanes : options.movement);
 }
 
 void Interpreter::printDebug() {
-    for (std::size_t y = 0; y < grid.size(); ++y) {
-        auto &line = grid[y];
-        for (std::size_t x = 0; x < line.size(); ++x) {
-            Object object = line[x];
-            std::cout << object;
+    for (std::size_t y = 0; y < grid.getHeight(); ++y) {
+        for (std::size_t x = 0; x < grid.getWidth(); ++x) {
+            std::cout << grid.get(grid.index(x, y));
         }
         std::cout << "\n";
     }
 
     std::cout << "\n\n";
 
-    for (std::size_t y = 0; y < grid.size(); ++y) {
-        auto &line = grid[y];
-        for (std::size_t x = 0; x < line.size(); ++x) {
-            Object object = line[x];
-            if (object.type == Object::Type::Data) {
-                if (object.data.type == Data::Type::Number) {
-                    std::cout << "(" << x << "," << y << ") " << object.data.number << "\n";
-                } else if (object.data.type == Data::Type::String) {
-                    std::cout << "(" << x << "," << y << ") \"" << object.data.string << "\"\n";
+    for (std::size_t y = 0; y < grid.getHeight(); ++y) {
+        for (std::size_t x = 0; x < grid.getWidth(); ++x) {
+            std::size_t i = grid.index(x, y);
+            if (grid.type(i) == Object::Type::Data) {
+                const Data &data = grid.data(i);
+                if (data.type == Data::Type::Number) {
+                    std::cout << "(" << x << "," << y << ") " << data.number << "\n";
+                } else if (data.type == Data::Type::String) {
+                    std::cout << "(" << x << "," << y << ") \"" << data.string << "\"\n";
                 }
             }
         }
@@ -830,3 +604,45 @@ void Interpreter::printDebug() {
     std::cin.clear();
     while (std::cin.get() != '\n') {}
 }
+
+void Interpreter::printProfile() {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    std::cerr << "\n*********  Profile  *********\n\n";
+    std::cerr << std::left << std::setfill(' ');
+    std::cerr << std::setw(22) << "Ticks:"                << tick << "\n";
+    std::cerr << std::setw(22) << "Time (ms):"            << Milliseconds(profile.time).count() << "\n";
+#ifdef ROOP_COUNT_ALLOCATIONS
+    std::cerr << std::setw(22) << "Allocations:"          << profile.allocations << "\n";
+    std::cerr << std::setw(22) << "Allocating ticks:"     << profile.allocatingTicks << "\n";
+    std::cerr << std::setw(22) << "Last allocating tick:" << profile.lastAllocatingTick << "\n";
+    std::cerr << std::setw(22) << "Max tick allocations:" << profile.maxTickAllocations << " (tick " << profile.maxAllocationsTick << ")\n";
+#else
+    std::cerr << std::setw(22) << "Allocations:"          << "not counted (build with ROOP_COUNT_ALLOCATIONS)\n";
+#endif
+    std::cerr << std::setw(22) << "Skipped ticks:"        << skippedTicks << "\n";
+    std::cerr << std::setw(22) << "Pure evaluations:"     << profile.pureEvaluations << "\n";
+    std::cerr << std::setw(22) << "Evaluation (ms):"      << Milliseconds(profile.evaluationTime).count() << "\n";
+    if (profile.pureEvaluations > 0)
+        std::cerr << std::setw(22) << "Evaluation (ns each):" << std::chrono::duration<double, std::nano>(profile.evaluationTime).count() / profile.pureEvaluations << "\n";
+    std::cerr << std::setw(22) << "Route steps:"          << pipeRoutes.getSize() << "\n";
+    std::cerr << std::setw(22) << "Pipe loops:"           << pipeRoutes.getLoops() << "\n";
+    std::cerr << std::setw(22) << "Teleports:"            << pipeRoutes.getTeleports() << "\n";
+    std::cerr << std::setw(22) << "Teleport routes:"      << pipeRoutes.getTeleportRoutes() << "\n";
+    std::cerr << std::setw(22) << "Unpaired teleports:"   << pipeRoutes.getUnpairedTeleports() << "\n";
+    if (options.compiled) {
+        std::cerr << std::setw(22) << "Graph nodes:"          << graph.getNodes() << "\n";
+        std::cerr << std::setw(22) << "Graph edges:"          << graph.getEdges() << "\n";
+    }
+
+    std::size_t cells = grid.getWidth() * grid.getHeight();
+    std::size_t bytes = grid.getMemoryUsage() + writeLog.getMemoryUsage()
+                      + movement.getMemoryUsage()
+                      + activeOperators.capacity() * sizeof(std::size_t)
+                      + graph.getMemoryUsage();
+
+    std::cerr << "\n";
+    std::cerr << std::setw(22) << "Cells:"                << cells << "\n";
+    std::cerr << std::setw(22) << "Grid bytes:"           << bytes << "\n";
+    std::cerr << std::setw(22) << "Bytes per cell:"       << static_cast<double>(bytes) / cells << "\n";
+}
@@ -19,50 +19,103 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #pragma once
 
+#include "DataflowGraph.h"
+#include "Movement.h"
 #include "Object.h"
+#include "Runtime.h"
 #include "TestManager.h"
+#include "ThreadPool.h"
 
+#include <chrono>
 #include <map>
 #include <memory>
-#include <random>
 #include <string>
 #include <utility>
 #include <vector>
 
-typedef std::vector<std::vector<Object>> Grid;
-typedef std::vector<std::string> GridSource;
-
-class Interpreter {
+class Interpreter : public Runtime {
 public:
-    Interpreter(bool debugMode, TestManager::Test *test = nullptr);
+    struct Options {
+        bool debug = false;
+        // Print execution statistics to the error output at the end.
+        bool profile = false;
+        // Algorithm used to resolve the movement of the Data in the second stage.
+        Movement::Engine movement = Movement::Engine::Event;
+        // Threads used to evaluate the operators in the first stage, the results do not depend on it.
+        std::size_t threads = 1;
+        // Look up the operators next to the Data and the walls of their lanes in a cache built from
+        // the static cells of the program (see DataflowGraph) instead of looking at the cells around
+        // them. The Data still move on the grid, so the results are the same.
+        bool compiled = false;
+    };
 
-    std::string getInputString();
-    Number getInputNumber();
-    void output(const std::string &s);
-    void output(Number n);
-    void halt(bool print = false);
-    Number rand(Number n = 0);
+    Interpreter(const Options &options, TestManager::Test *test = nullptr);
 
-    bool load(std::stringstream &stream);
+    // Parses a program, the text is not used after the call.
+    bool load(const char *text, std::size_t size);
     bool execute();
-
-    Number tick;
 private:
+    // Results of the rules of an operator that matched its neighbours in a tick, in the order in which
+    // they have to be applied. An operator with separate axes can match one rule in each axis.
+    struct Evaluation {
+        enum class Axis : std::uint8_t {Both, Vertical, Horizontal};
+        struct Match {
+            std::size_t rule;
+            Axis axis;
+            Result result;
+        };
+
+        Match matches[2];
+        std::size_t count;
+    };
+    struct Profile {
+        std::chrono::steady_clock::duration time;
+        std::size_t allocations = 0;
+        Number allocatingTicks = 0;
+        Number lastAllocatingTick = -1;
+        std::size_t maxTickAllocations = 0;
+        Number maxAllocationsTick = -1;
+        // Allocations made before the current tick.
+        std::size_t tickStartAllocations = 0;
+        // Operators evaluated in the pure pass of the first stage, and the time spent in that pass.
+        std::size_t pureEvaluations = 0;
+        std::chrono::steady_clock::duration evaluationTime{};
+    };
+    // Text of the program being loaded. The lines are not copied or padded, getSourceChar() adds the
+    // border and the padding.
+    struct Source {
+        const char *text = nullptr;
+        // Start of each line, followed by the end of the last one plus one.
+        std::vector<std::size_t> lines;
+        std::size_t width = 0;
+        std::size_t height = 0;
+        // Cells already read as part of a literal.
+        std::vector<bool> consumed;
+    };
+
     bool parse();
+    char getSourceChar(std::size_t x, std::size_t y) const;
     Object parseLiteral(char ch, std::size_t x, std::size_t y);
 
-    void firstStage();
-    void secondStage();
-    void printAllObject();
+    void beginTick() override;
+    void endTick() override;
+    void findActiveOperators();
+    void firstStage() override;
+    void evaluate(std::size_t i, Evaluation &evaluation) const;
+    // routes are the entries of the pipes around the operator in the compiled graph, or null.
+    void apply(std::size_t i, Evaluation &evaluation, const std::uint32_t *routes = nullptr);
+    void secondStage() override;
 
     void printDebug();
+    void printProfile();
 
-    Grid grid;
-    GridSource gridSource;
-    bool ended;
-    bool printAll;
-    bool debugMode;
-    bool testMode;
-    TestManager::Test *test;
-    std::mt19937_64 randomEngine;
+    std::vector<std::size_t> activeOperators;
+    // Nodes of the active operators, when the compiled graph is used.
+    std::vector<std::uint32_t> activeNodes;
+    std::vector<Evaluation> evaluations;
+    std::unique_ptr<ThreadPool> threadPool;
+    DataflowGraph graph;
+    Source source;
+    Options options;
+    Profile profile;
 };
@@ -0,0 +1,86 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ROOP_MMAP
+#endif
+
+MappedFile::MappedFile(const char *path) {
+#ifdef ROOP_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+        void *address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+            contents = static_cast<const char *>(address);
+            length = static_cast<std::size_t>(status.st_size);
+            mapped = true;
+        }
+    }
+
+    ::close(fd);
+
+    if (mapped) {
+        open = true;
+        return;
+    }
+#endif
+
+    // Text mode, so the line endings are translated where the system needs it.
+    std::ifstream file(path);
+    if (!file.is_open())
+        return;
+
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    contents = buffer.data();
+    length = buffer.size();
+    open = true;
+}
+
+MappedFile::~MappedFile() {
+#ifdef ROOP_MMAP
+    if (mapped)
+        munmap(const_cast<char *>(contents), length);
+#endif
+}
+
+bool MappedFile::isOpen() const {
+    return open;
+}
+
+const char *MappedFile::data() const {
+    return contents;
+}
+
+std::size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,266 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "Movement.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+void Movement::reset(const Grid &grid, const DataflowGraph *lanes) {
+    this->lanes = lanes;
+    stateGrid.resize(grid.getWidth() * grid.getHeight());
+    for (std::size_t i = 0; i < stateGrid.size(); ++i)
+        resetState(grid, i);
+    // The first stage can clear them before their states are used.
+    touchedStates = grid.getDataCells();
+    actionableMoves.resize(stateGrid.size());
+}
+
+void Movement::run(Grid &grid, Engine engine) {
+    const std::size_t width = grid.getWidth();
+
+    // The states persist between ticks, so only the ones changed in the previous tick are reset.
+    for (std::size_t i : touchedStates)
+        resetState(grid, i);
+    touchedStates.clear();
+
+    if (engine == Engine::Lanes) {
+        moveLanes(grid);
+        return;
+    }
+
+    for (std::size_t i : grid.getDataCells()) {
+        State &state = stateGrid[i];
+        state.fixed = false;
+        state.empty = false;
+        state.direction = util::Dir::Down;
+
+        std::size_t side = (grid.data(i).direction == util::Dir::Left) ? i - 1 : i + 1;
+        ++stateGrid[i + width].attemptsToOccupy;
+        ++stateGrid[side].attemptsToOccupy;
+
+        touchedStates.push_back(i);
+        touchedStates.push_back(i + width);
+        touchedStates.push_back(side);
+    }
+
+    switch (engine) {
+        case Engine::Event: moveEvents(grid); break;
+        case Engine::Scan:  moveScan(grid);   break;
+        default:            break;
+    }
+}
+
+// Scans the grid in order moving the Data that is not fixed, until all of it is, restarting from
+// the beginning when needed.
+void Movement::moveScan(Grid &grid) {
+    const std::size_t width = grid.getWidth();
+
+    bool toMove = true;
+    while (toMove) {
+        start:
+        toMove = false;
+
+        for (std::size_t y = 1; y < grid.getHeight() - 1; ++y) {
+            // Only Data cells can be waiting to move, so tiles without any are skipped.
+            for (std::size_t tileX = 0; tileX < width - 1; tileX += Grid::tileSize) {
+                if (grid.getTile(tileX, y).data == 0)
+                    continue;
+
+                std::size_t tileEnd = std::min(tileX + Grid::tileSize, width - 1);
+                for (std::size_t x = std::max<std::size_t>(tileX, 1); x < tileEnd; ++x) {
+                    std::size_t i = grid.index(x, y);
+                    State &state = stateGrid[i];
+
+                    if (state.fixed || state.empty)
+                        continue;
+
+                    toMove = true;
+
+                    if (moveStep(grid, i))
+                        goto start;
+                }
+            }
+        }
+    }
+}
+
+// Gives the same moves as moveScan. Visiting a cell whose target is another Data that is still moving
+// (and not towards it) does nothing, so only the cells that would do something are kept, in the order
+// of the scan. The others wait on their target, and are only looked at again when its state changes
+// (see schedule and wake). The scan then jumps from one cell of the set to the next, and a restart
+// jumps to the first one, instead of going over the whole grid. With walls, a Data that tries to go
+// into a wall of its lane turns or stops without looking at the cell (see moveLanes).
+void Movement::moveEvents(Grid &grid, bool walls) {
+    for (std::size_t i : grid.getDataCells())
+        schedule(grid, i, walls);
+
+    std::size_t position = 0;
+    while (true) {
+        std::size_t i = actionableMoves.next(position);
+        if (i == OrderedBitSet::none) {
+            // End of the scan, start another one.
+            i = actionableMoves.next(0);
+            if (i == OrderedBitSet::none)
+                return;
+        }
+
+        State &state = stateGrid[i];
+        bool restart = false;
+        if (!walls || !lanes->wall(i, state.direction)) {
+            restart = moveStep(grid, i);
+        } else if (state.direction == util::Dir::Down) {
+            state.direction = grid.data(i).direction;
+        } else {
+            state.fixed = true;
+        }
+
+        // The cell is now empty, fixed or tries another side, and that is the only change to a state
+        // that can let others move: the Data that lands in an empty cell is fixed, and the cells
+        // that wanted it could already move.
+        schedule(grid, i, walls);
+        wake(grid, i, walls);
+
+        position = restart ? 0 : i + 1;
+    }
+}
+
+// Movement of the compiled engine: the same moves as moveEvents, but a Data that tries to go into
+// a wall of its lane turns or stops without looking at the cell, so the static cells are never
+// counted as targets, touched or visited.
+void Movement::moveLanes(Grid &grid) {
+    const std::size_t width = grid.getWidth();
+
+    for (std::size_t i : grid.getDataCells()) {
+        State &state = stateGrid[i];
+        state.fixed = false;
+        state.empty = false;
+        state.direction = util::Dir::Down;
+        touchedStates.push_back(i);
+
+        if (!lanes->wall(i, util::Dir::Down)) {
+            ++stateGrid[i + width].attemptsToOccupy;
+            touchedStates.push_back(i + width);
+        }
+        util::Dir side = grid.data(i).direction;
+        if (!lanes->wall(i, side)) {
+            std::size_t target = (side == util::Dir::Left) ? i - 1 : i + 1;
+            ++stateGrid[target].attemptsToOccupy;
+            touchedStates.push_back(target);
+        }
+    }
+
+    moveEvents(grid, true);
+}
+
+// Tries to move the Data of a cell that is not fixed one step. Returns true when the scan must
+// restart from the beginning.
+bool Movement::moveStep(Grid &grid, std::size_t i) {
+    State &state = stateGrid[i];
+    std::size_t newI = moveTarget(grid, i);
+
+    State &newState = stateGrid[newI];
+    if (newState.empty) {
+        moveObject(grid, i, newI);
+        --newState.attemptsToOccupy;
+        if (state.attemptsToOccupy > 1)
+            return true;
+    } else if (newState.fixed) {
+        if (state.direction == util::Dir::Down)
+            state.direction = grid.data(i).direction;
+        else
+            state.fixed = true;
+        --newState.attemptsToOccupy;
+    } else if (state.direction == util::invert(newState.direction)) {
+        state.fixed = true;
+        --newState.attemptsToOccupy;
+    }
+
+    return false;
+}
+
+// Cell that the Data of a cell that is not fixed tries to occupy.
+std::size_t Movement::moveTarget(const Grid &grid, std::size_t i) const {
+    switch (stateGrid[i].direction) {
+        case util::Dir::Up:     return i - grid.getWidth();
+        case util::Dir::Down:   return i + grid.getWidth();
+        case util::Dir::Left:   return i - 1;
+        case util::Dir::Right:  return i + 1;
+        default: assert(false); abort();
+    }
+}
+
+// Whether moveStep would change something in the cell.
+bool Movement::canMove(const Grid &grid, std::size_t i) const {
+    const State &state = stateGrid[i];
+    if (state.fixed || state.empty)
+        return false;
+
+    const State &target = stateGrid[moveTarget(grid, i)];
+    return target.empty || target.fixed || (state.direction == util::invert(target.direction));
+}
+
+// Adds the cell to the actionable set if visiting it would change something. Otherwise, if its Data
+// is still moving, it waits on its target.
+void Movement::schedule(const Grid &grid, std::size_t i, bool walls) {
+    const State &state = stateGrid[i];
+    if (state.fixed || state.empty) {
+        actionableMoves.erase(i);
+    } else if ((walls && lanes->wall(i, state.direction)) || canMove(grid, i)) {
+        actionableMoves.insert(i);
+    } else {
+        actionableMoves.erase(i);
+        stateGrid[moveTarget(grid, i)].waiters |= std::uint8_t(1) << static_cast<unsigned>(state.direction);
+    }
+}
+
+// Schedules again the cells that wait on this one, after its state changed.
+void Movement::wake(const Grid &grid, std::size_t i, bool walls) {
+    std::uint8_t waiters = stateGrid[i].waiters;
+    stateGrid[i].waiters = 0;
+
+    // The bit of each direction is the one of the Data that tries to come from the opposite side.
+    if (waiters & (std::uint8_t(1) << static_cast<unsigned>(util::Dir::Down)))
+        schedule(grid, i - grid.getWidth(), walls);
+    if (waiters & (std::uint8_t(1) << static_cast<unsigned>(util::Dir::Right)))
+        schedule(grid, i - 1, walls);
+    if (waiters & (std::uint8_t(1) << static_cast<unsigned>(util::Dir::Left)))
+        schedule(grid, i + 1, walls);
+}
+
+void Movement::moveObject(Grid &grid, std::size_t from, std::size_t to) {
+    grid.move(from, to);
+    stateGrid[to].fixed = true;
+    stateGrid[to].empty = false;
+    stateGrid[from].fixed = false;
+    stateGrid[from].empty = true;
+}
+
+void Movement::resetState(const Grid &grid, std::size_t i) {
+    State &state = stateGrid[i];
+    state.fixed = (grid.type(i) != Object::Type::Empty);
+    state.empty = (grid.type(i) == Object::Type::Empty);
+    state.attemptsToOccupy = 0;
+    state.waiters = 0;
+}
+
+std::size_t Movement::getMemoryUsage() const {
+    return stateGrid.capacity() * sizeof(State) + touchedStates.capacity() * sizeof(std::size_t);
+}
@@ -0,0 +1,72 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "DataflowGraph.h"
+#include "Grid.h"
+#include "OrderedBitSet.h"
+#include "Util.h"
+
+#include <cstdint>
+#include <vector>
+
+// Second stage of a tick: every Data that is not fixed tries to fall, then to move to its side, and
+// stops when it can not. The cells are visited in the order of the grid, and the whole scan starts
+// again when a Data moves into a cell that more than one of them wanted.
+class Movement {
+public:
+    // Algorithms that resolve the movement, all of them give the same results. Lanes needs the walls
+    // of a DataflowGraph (see reset).
+    enum class Engine {Event, Scan, Lanes};
+
+    // Prepares the states for a grid that has just been loaded.
+    void reset(const Grid &grid, const DataflowGraph *lanes = nullptr);
+    void run(Grid &grid, Engine engine);
+
+    std::size_t getMemoryUsage() const;
+private:
+    struct State {
+        bool fixed;
+        bool empty;
+        util::Dir direction;
+        std::int8_t attemptsToOccupy;
+        // Directions of the Data around that wait for this cell to change before they can move, one
+        // bit for each util::Dir (see wake).
+        std::uint8_t waiters;
+    };
+
+    void moveScan(Grid &grid);
+    void moveEvents(Grid &grid, bool walls = false);
+    void moveLanes(Grid &grid);
+    bool moveStep(Grid &grid, std::size_t i);
+    std::size_t moveTarget(const Grid &grid, std::size_t i) const;
+    bool canMove(const Grid &grid, std::size_t i) const;
+    void schedule(const Grid &grid, std::size_t i, bool walls);
+    void wake(const Grid &grid, std::size_t i, bool walls);
+    void moveObject(Grid &grid, std::size_t from, std::size_t to);
+    void resetState(const Grid &grid, std::size_t i);
+
+    const DataflowGraph *lanes = nullptr;
+    std::vector<State> stateGrid;
+    std::vector<std::size_t> touchedStates;
+    // Cells with Data that is not fixed and would change something when visited, used by the event
+    // driven movement.
+    OrderedBitSet actionableMoves;
+};
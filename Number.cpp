@@ -19,6 +19,18 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "Number.h"
 
+#ifdef ROOP_BIG_NUMBERS
+
+std::string toString(Number number) {
+    return number.toString();
+}
+
+bool fromString(const std::string &s, Number &number) {
+    return Number::fromString(s, number);
+}
+
+#else
+
 std::string toString(Number number) {
     return std::to_string(number);
 }
@@ -29,3 +41,5 @@ bool fromString(const std::string &s, Number &number) try {
 } catch(...) {
     return false;
 }
+
+#endif
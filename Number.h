@@ -19,9 +19,29 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #pragma once
 
+#include "Util.h"
+
+#include <cstdint>
 #include <string>
 
+// Numbers are long long unless ROOP_BIG_NUMBERS is defined, which makes them arbitrarily large.
+#ifdef ROOP_BIG_NUMBERS
+#include "BigNumber.h"
+using Number = BigNumber;
+#else
 using Number = long long;
+#endif
 
 std::string toString(Number number);
 bool fromString(const std::string &s, Number &number);
+
+// Equal for equal numbers.
+inline util::Hash hashNumber(const Number &number) {
+#ifdef ROOP_BIG_NUMBERS
+    return number.hash();
+#else
+    util::Hash hash;
+    hash.first = hash.second = static_cast<std::uint64_t>(number);
+    return hash;
+#endif
+}
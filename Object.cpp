@@ -20,12 +20,44 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "Object.h"
 
 #include <cctype>
+#include <utility>
 
 void Object::clear() {
-    type = Type::Empty;
-    data.type = Data::Type::None;
-    data.string.clear();
-    data.direction = util::Dir::Right;
+    *this = Object();
+}
+
+Result::Result(const Result &other):
+success(other.success),
+up     (other.up),
+left   (other.left),
+right  (other.right),
+down   (other.down) {
+}
+
+Result::Result(Result &&other):
+success(other.success),
+up     (std::move(other.up)),
+left   (std::move(other.left)),
+right  (std::move(other.right)),
+down   (std::move(other.down)) {
+}
+
+Result &Result::operator=(const Result &other) {
+    success = other.success;
+    up      = other.up;
+    left    = other.left;
+    right   = other.right;
+    down    = other.down;
+    return *this;
+}
+
+Result &Result::operator=(Result &&other) {
+    success = other.success;
+    up      = std::move(other.up);
+    left    = std::move(other.left);
+    right   = std::move(other.right);
+    down    = std::move(other.down);
+    return *this;
 }
 
 Object Object::CreateOperator(char ch) {
@@ -39,261 +71,52 @@ Object Object::CreateOperator(char ch) {
     }
     obj.op.noRemove = lower;
 
-    using DType = Data::Type;
-
     switch (ch) {
         case 'W':
             if (lower) {
                 obj.op.code = Operator::Code::w;
-                obj.op.io.push_back({{DType::Input, DType::None, DType::None, DType::Output}, // Requirements: up, left, right, down
-                                    {}});                                                     // Outcome:      down, right, left, up
-                obj.op.io.push_back({{DType::NorS, DType::None, DType::None, DType::Output},
-                                    {}});
-                obj.op.io.push_back({{DType::Input},
-                                    {DType::Number}});
             } else {
                 obj.op.code = Operator::Code::W;
-                obj.op.io.push_back({{DType::Input, DType::None, DType::None, DType::Output},
-                                    {}});
-                obj.op.io.push_back({{DType::NorS, DType::None, DType::None, DType::Output},
-                                    {}});
-                obj.op.io.push_back({{DType::Input},
-                                    {DType::String}});
                 obj.op.noRemove = true;
             }
             break;
         case 'C':
             if (lower) {
                 obj.op.code = Operator::Code::c;
-                obj.op.io.push_back({{DType::Any,  DType::None, DType::None, DType::Any},
-                                    {DType::Any,  DType::None, DType::None, DType::Any}});
-                obj.op.separateAxes = true;
-                obj.op.replace = true;
             } else {
                 obj.op.code = Operator::Code::C;
                 obj.op.noRemove = true;
-                obj.op.io.push_back({{DType::Any,  DType::Any,  DType::Any,  DType::None},
-                                    {DType::None,  DType::Any,  DType::Any,  DType::Any}});
-                obj.op.io.push_back({{DType::Any,  DType::Any},
-                                    {DType::None,  DType::None, DType::Any}});
-                obj.op.io.push_back({{DType::Any,  DType::None, DType::Any},
-                                    {DType::None,  DType::Any,  DType::None, DType::Any}});
-                obj.op.io.push_back({{DType::Any},
-                                    {DType::None,  DType::None, DType::None, DType::Any}});
-                obj.op.io.push_back({{DType::None, DType::Any,  DType::Any},
-                                    {DType::None,  DType::Any,  DType::Any}});
-                obj.op.io.push_back({{DType::None, DType::Any,  DType::None},
-                                    {DType::None,  DType::None, DType::Any}});
-                obj.op.io.push_back({{DType::None, DType::None, DType::Any},
-                                    {DType::None,  DType::Any}});
-                obj.op.replace = true;
             }
             break;
-        case 'L':
-            obj.op.code = Operator::Code::L;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::String}});
-            obj.op.separateAxes = true;
-            break;
-        case 'U':
-            obj.op.code = Operator::Code::U;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::String}});
-            obj.op.separateAxes = true;
-            break;
-        case 'A':
-            obj.op.code = Operator::Code::A;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::None},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::None,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            break;
-        case 'S':
-            obj.op.code = Operator::Code::S;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::None},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::None,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            break;
-        case 'M':
-            obj.op.code = Operator::Code::M;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::None},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::None,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            break;
-        case 'D':
-            obj.op.code = Operator::Code::D;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String, DType::Number},
-                                {DType::String, DType::String}});
-            obj.op.io.push_back({{DType::String, DType::String},
-                                {DType::String, DType::String}});
-            break;
-        case 'R':
-            obj.op.code = Operator::Code::R;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::NorS},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            break;
-        case 'F':
-            obj.op.code = Operator::Code::F;
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS},
-                                {DType::Number}});
-            break;
-        case 'P':
-            obj.op.code = Operator::Code::P;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::Number}});
-            obj.op.separateAxes = true;
-            break;
-        case 'Z':
-            obj.op.code = Operator::Code::Z;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::String}});
-            obj.op.separateAxes = true;
-            break;
+        case 'L': obj.op.code = Operator::Code::L; break;
+        case 'U': obj.op.code = Operator::Code::U; break;
+        case 'A': obj.op.code = Operator::Code::A; break;
+        case 'S': obj.op.code = Operator::Code::S; break;
+        case 'M': obj.op.code = Operator::Code::M; break;
+        case 'D': obj.op.code = Operator::Code::D; break;
+        case 'R': obj.op.code = Operator::Code::R; break;
+        case 'F': obj.op.code = Operator::Code::F; break;
+        case 'P': obj.op.code = Operator::Code::P; break;
+        case 'Z': obj.op.code = Operator::Code::Z; break;
 
 
-        case 'N':
-            obj.op.code = Operator::Code::N;
-            obj.op.io.push_back({{DType::Any},
-                                {DType::Number}});
-            obj.op.separateAxes = true;
-            break;
-        case 'E':
-            obj.op.code = Operator::Code::E;
-            obj.op.io.push_back({{DType::Any,  DType::Any,  DType::Any},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Any,  DType::Any,  DType::None},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Any,  DType::None, DType::Any},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None, DType::Any,  DType::Any},
-                                {DType::Number}});
-            break;
-        case 'G':
-            obj.op.code = Operator::Code::G;
-            obj.op.io.push_back({{DType::Number, DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::NorS},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::NorS,   DType::None},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Number, DType::None,   DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::NorS,   DType::None,   DType::NorS},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::Number, DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::None,   DType::NorS,   DType::NorS},
-                                {DType::Number}});
-            break;
-        case 'K':
-            obj.op.code = Operator::Code::K;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::String}});
-            obj.op.separateAxes = true;
-            break;
-        case 'Y':
-            obj.op.code = Operator::Code::Y;
-            obj.op.io.push_back({{DType::Number},
-                                {DType::String}});
-            obj.op.io.push_back({{DType::String},
-                                {DType::Number}});
-            obj.op.io.push_back({{DType::Input},
-                                {DType::Output}});
-            obj.op.io.push_back({{DType::Output},
-                                {DType::Input}});
-            obj.op.separateAxes = true;
-            break;
+        case 'N': obj.op.code = Operator::Code::N; break;
+        case 'E': obj.op.code = Operator::Code::E; break;
+        case 'G': obj.op.code = Operator::Code::G; break;
+        case 'K': obj.op.code = Operator::Code::K; break;
+        case 'Y': obj.op.code = Operator::Code::Y; break;
 
 
         case 'V':
             obj.op.code = Operator::Code::V;
-            obj.op.io.push_back({{DType::Any},
-                                 {DType::Any}});
             obj.type = Object::Type::SpecialOperator;
             break;
         case 'X':
             obj.op.code = Operator::Code::X;
-            obj.op.io.push_back({{DType::Any,  DType::None, DType::None, DType::Any},
-                                 {}});
-            obj.op.io.push_back({{DType::Any},
-                                 {}});
-            obj.op.io.push_back({{DType::None, DType::None, DType::None, DType::Any},
-                                 {}});
-            obj.op.separateAxes = true;
             obj.type = Object::Type::SpecialOperator;
             break;
         case 'T':
             obj.op.code = Operator::Code::T;
-            obj.op.io.push_back({{DType::Any},
-                                 {DType::Number}});
             obj.type = Object::Type::SpecialOperator;
             break;
         case 'H':
@@ -302,8 +125,6 @@ Object Object::CreateOperator(char ch) {
             } else {
                 obj.op.code = Operator::Code::H;
             }
-            obj.op.io.push_back({{DType::Any},
-                                 {}});
             obj.type = Object::Type::SpecialOperator;
             break;
     }
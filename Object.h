@@ -23,13 +23,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "Operator.h"
 #include "Pipe.h"
 #include <array>
+#include <cstdint>
 #include <iostream>
 
 struct Result;
 
 class Object {
 public:
-    enum class Type {
+    enum class Type : std::uint8_t {
         Empty           = 0b00000,
         Data            = 0b00001,
         NormalOperator  = 0b00010,
@@ -53,6 +54,13 @@ private:
 };
 
 struct Result {
+    Result() = default;
+    // first and second must keep referring to the members of this Result, not of the copied one.
+    Result(const Result &other);
+    Result(Result &&other);
+    Result &operator=(const Result &other);
+    Result &operator=(Result &&other);
+
     bool success;
     Object up;
     Object left;
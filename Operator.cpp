@@ -19,21 +19,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "Operator.h"
 
-#include "Interpreter.h"
 #include "Object.h"
+#include "Primes.h"
+#include "Rules.h"
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <stdexcept>
+#include <vector>
 
-namespace {
-
-void setType(Data::Type type, Object &obj) {
-    if (type != Data::Type::None) {
-        obj.type = Object::Type::Data;
-        if (type != Data::Type::Any)
-            obj.data.type = type;
-    }
-}
+namespace rules {
 
 bool isAlpha(char ch) {
     return ((ch >= 'a') && (ch <= 'z')) || ((ch >= 'A') && (ch <= 'Z'));
@@ -55,76 +50,121 @@ std::string toUpper(std::string s) {
     return s;
 }
 
+// Removes the first occurrence until there are none left, also the ones that appear when the parts
+// around a removed one are joined. That is the same as copying the characters one by one and removing
+// the end of the copy whenever it matches, so the state of a Knuth-Morris-Pratt matcher is kept for
+// every copied character to resume from it after a removal, which makes it linear.
 std::string removeString(std::string s, const std::string &toRemove) {
-    if (s.empty() || toRemove.empty())
+    if (s.empty() || toRemove.empty() || (s.find(toRemove) == std::string::npos))
         return s;
 
-    size_t pos;
-    while((pos = s.find(toRemove)) != std::string::npos) {
-        std::string sub = s.substr(0, pos);
-
-        if((pos + toRemove.length()) < s.length())
-            sub += s.substr(pos + toRemove.length());
+    const std::size_t size = toRemove.size();
+    std::vector<std::size_t> failure(size, 0);
+    for (std::size_t i = 1, matched = 0; i < size; ++i) {
+        while ((matched > 0) && (toRemove[i] != toRemove[matched]))
+            matched = failure[matched - 1];
+        if (toRemove[i] == toRemove[matched])
+            ++matched;
+        failure[i] = matched;
+    }
 
-        s = sub;
+    std::string result;
+    result.reserve(s.size());
+    std::vector<std::size_t> states;
+    states.reserve(s.size());
+    std::size_t matched = 0;
+    for (char ch : s) {
+        while ((matched > 0) && (ch != toRemove[matched]))
+            matched = failure[matched - 1];
+        if (ch == toRemove[matched])
+            ++matched;
+
+        result += ch;
+        states.push_back(matched);
+        if (matched == size) {
+            result.resize(result.size() - size);
+            states.resize(states.size() - size);
+            matched = states.empty() ? 0 : states.back();
+        }
     }
-    return s;
+
+    return result;
 }
 
+// The copies are made by doubling the result, so the work is linear and there are only log2(n) calls.
 std::string repeatString(const std::string &s, Number n) {
-    std::string result;
-
-    if (n < 1)
+    if ((n < 1) || s.empty())
         return "";
-    else
-        for (Number i = 0; i < n; ++i)
-            result += s;
+
+    std::size_t count = static_cast<std::size_t>(n);
+    if (count > std::string().max_size() / s.size())
+        throw std::length_error("repeatString");
+
+    const std::size_t size = s.size() * count;
+    std::string result;
+    result.reserve(size);
+    result = s;
+    while (result.size() <= size / 2)
+        result.append(result);
+    result.append(result, 0, size - result.size());
 
     return result;
 }
 
-std::string repeatString(const Object &a, const Object &b, const Object &c, bool &success) {
+std::string repeatString(const Data &a, const Data &b, const Data &c, bool &success) {
     success = true;
 
-    if ((a.data.type == Data::Type::String) && (b.data.type == Data::Type::Number) && (c.data.type == Data::Type::Number)) {
-        return repeatString(a.data.string, b.data.number * c.data.number);
-    } else if ((a.data.type == Data::Type::Number) && (b.data.type == Data::Type::String) && (c.data.type == Data::Type::Number)) {
-        return repeatString(b.data.string, a.data.number * c.data.number);
-    } else if ((a.data.type == Data::Type::Number) && (b.data.type == Data::Type::Number) && (c.data.type == Data::Type::String)) {
-        return repeatString(c.data.string, a.data.number * b.data.number);
+    if ((a.type == Data::Type::String) && (b.type == Data::Type::Number) && (c.type == Data::Type::Number)) {
+        return repeatString(a.string.str(), b.number * c.number);
+    } else if ((a.type == Data::Type::Number) && (b.type == Data::Type::String) && (c.type == Data::Type::Number)) {
+        return repeatString(b.string.str(), a.number * c.number);
+    } else if ((a.type == Data::Type::Number) && (b.type == Data::Type::Number) && (c.type == Data::Type::String)) {
+        return repeatString(c.string.str(), a.number * b.number);
     }
 
     success = false;
     return "";
 }
 
-std::string repeatString(const Object &a, const Object &b, bool &success) {
+std::string repeatString(const Data &a, const Data &b, bool &success) {
     success = true;
 
-    if ((a.data.type == Data::Type::String) && (b.data.type == Data::Type::Number)) {
-        return repeatString(a.data.string, b.data.number);
-    } else if ((a.data.type == Data::Type::Number) && (b.data.type == Data::Type::String)) {
-        return repeatString(b.data.string, a.data.number);
+    if ((a.type == Data::Type::String) && (b.type == Data::Type::Number)) {
+        return repeatString(a.string.str(), b.number);
+    } else if ((a.type == Data::Type::Number) && (b.type == Data::Type::String)) {
+        return repeatString(b.string.str(), a.number);
     }
 
     success = false;
     return "";
 }
 
+// The occurrences are counted first to reserve the exact size of the result, which is then built in
+// a single pass. std::string::find looks for the first character with memchr.
 std::string replaceString(std::string s, const std::string &from, const std::string &to) {
     if (from.empty())
         return s;
 
-    size_t pos = 0;
-    while ((pos = s.find(from, pos)) != std::string::npos) {
-        s.replace(pos, from.length(), to);
-        pos += to.length();
+    std::size_t count = 0;
+    for (std::size_t pos = s.find(from); pos != std::string::npos; pos = s.find(from, pos + from.size()))
+        ++count;
+    if (count == 0)
+        return s;
+
+    std::string result;
+    result.reserve(s.size() - count * from.size() + count * to.size());
+    std::size_t last = 0;
+    for (std::size_t pos = s.find(from); pos != std::string::npos; pos = s.find(from, last)) {
+        result.append(s, last, pos - last);
+        result += to;
+        last = pos + from.size();
     }
+    result.append(s, last, std::string::npos);
 
-    return s;
+    return result;
 }
 
-void cutString(std::string s, Number pos, std::string &first, std::string &last) {
+void cutString(std::string s, Number pos, SharedString &first, SharedString &last) {
     if (pos < 0)
         pos = s.length() + pos;
 
@@ -136,11 +176,11 @@ void cutString(std::string s, Number pos, std::string &first, std::string &last)
         last = "";
     }
 
-    first = s.substr(0, pos);
-    last = s.substr(pos);
+    first = s.substr(0, static_cast<std::size_t>(pos));
+    last = s.substr(static_cast<std::size_t>(pos));
 }
 
-void cutString(std::string s, const std::string &delimiter, std::string &first, std::string &last) {
+void cutString(std::string s, const std::string &delimiter, SharedString &first, SharedString &last) {
     if (delimiter.empty()) {
         first = s;
         last = "";
@@ -185,6 +225,10 @@ std::string reverse(std::string s) {
     return s;
 }
 
+Number absolute(Number n) {
+    return (n < 0) ? -n : n;
+}
+
 Number sign(Number n) {
     if (n > 0)
         return 1;
@@ -195,29 +239,16 @@ Number sign(Number n) {
 }
 
 bool isPrime(Number n) {
-    if (n < 0)
-        n = std::abs(n);
-
-    if (n < 2)
-        return false;
-
-    if (n == 2)
-        return true;
-
-    if (n % 2 == 0)
-        return false;
-
-    for (Number i = 3; (i * i) <= n; i += 2) {
-        if (n % i == 0)
-            return false;
-    }
-
-    return true;
+#ifdef ROOP_BIG_NUMBERS
+    return isBigPrime(absolute(n));
+#else
+    return ::isPrime(n < 0 ? 0 - static_cast<std::uint64_t>(n) : static_cast<std::uint64_t>(n));
+#endif
 }
 
 Number gcd(Number a, Number b) {
-    a = std::abs(a);
-    b = std::abs(b);
+    a = absolute(a);
+    b = absolute(b);
 
     while (b != 0) {
         Number t = b;
@@ -242,417 +273,343 @@ Number find(const std::string &s, const std::string &toFind) {
 
 }
 
+namespace {
 
-Interpreter *Operator::interpreter = nullptr;
-
-Result Operator::processAll(std::size_t n, Object &up, Object &left, Object &right, Object &/*down*/) {
-    Result result;
-    result.success = true;
-
-    setType(io[n].out.down,  result.down);
-    setType(io[n].out.right, result.right);
-    setType(io[n].out.left,  result.left);
-    setType(io[n].out.up,    result.up);
+using namespace rules;
+
+using DataPair = Operator::DataPair;
+
+constexpr DataPair ioW[] = {
+    {{DType::Input, DType::None, DType::None, DType::Output}, // Requirements: up, left, right, down
+     {}},                                                     // Outcome:      down, right, left, up
+    {{DType::NorS, DType::None, DType::None, DType::Output},
+     {}},
+    {{DType::Input},
+     {DType::String}}
+};
+
+constexpr DataPair iow[] = {
+    {{DType::Input, DType::None, DType::None, DType::Output},
+     {}},
+    {{DType::NorS, DType::None, DType::None, DType::Output},
+     {}},
+    {{DType::Input},
+     {DType::Number}}
+};
+
+constexpr DataPair ioC[] = {
+    {{DType::Any,  DType::Any,  DType::Any,  DType::None},
+     {DType::None,  DType::Any,  DType::Any,  DType::Any}},
+    {{DType::Any,  DType::Any},
+     {DType::None,  DType::None, DType::Any}},
+    {{DType::Any,  DType::None, DType::Any},
+     {DType::None,  DType::Any,  DType::None, DType::Any}},
+    {{DType::Any},
+     {DType::None,  DType::None, DType::None, DType::Any}},
+    {{DType::None, DType::Any,  DType::Any},
+     {DType::None,  DType::Any,  DType::Any}},
+    {{DType::None, DType::Any,  DType::None},
+     {DType::None,  DType::None, DType::Any}},
+    {{DType::None, DType::None, DType::Any},
+     {DType::None,  DType::Any}}
+};
+
+constexpr DataPair ioc[] = {
+    {{DType::Any,  DType::None, DType::None, DType::Any},
+     {DType::Any,  DType::None, DType::None, DType::Any}}
+};
+
+// Used by L, U, K and Z.
+constexpr DataPair ioSameType[] = {
+    {{DType::Number},
+     {DType::Number}},
+    {{DType::String},
+     {DType::String}}
+};
+
+// Used by A, S and M.
+constexpr DataPair ioArithmetic[] = {
+    {{DType::Number, DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS,   DType::NorS},
+     {DType::String}},
+    {{DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS,   DType::None},
+     {DType::String}},
+    {{DType::Number, DType::None,   DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::None,   DType::NorS},
+     {DType::String}},
+    {{DType::None,   DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::None,   DType::NorS,   DType::NorS},
+     {DType::String}}
+};
+
+constexpr DataPair ioD[] = {
+    {{DType::Number, DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::Number, DType::None,   DType::Number},
+     {DType::Number}},
+    {{DType::None,   DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::String, DType::Number},
+     {DType::String, DType::String}},
+    {{DType::String, DType::String},
+     {DType::String, DType::String}}
+};
+
+constexpr DataPair ioR[] = {
+    {{DType::Number, DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS,   DType::NorS},
+     {DType::String}},
+    {{DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::Number, DType::None,   DType::Number},
+     {DType::Number}},
+    {{DType::None,   DType::Number, DType::Number},
+     {DType::Number}}
+};
+
+constexpr DataPair ioF[] = {
+    {{DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS},
+     {DType::Number}}
+};
+
+constexpr DataPair ioP[] = {
+    {{DType::Number},
+     {DType::Number}},
+    {{DType::String},
+     {DType::Number}}
+};
+
+constexpr DataPair ioN[] = {
+    {{DType::Any},
+     {DType::Number}}
+};
+
+constexpr DataPair ioE[] = {
+    {{DType::Any,  DType::Any,  DType::Any},
+     {DType::Number}},
+    {{DType::Any,  DType::Any,  DType::None},
+     {DType::Number}},
+    {{DType::Any,  DType::None, DType::Any},
+     {DType::Number}},
+    {{DType::None, DType::Any,  DType::Any},
+     {DType::Number}}
+};
+
+constexpr DataPair ioG[] = {
+    {{DType::Number, DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS,   DType::NorS},
+     {DType::Number}},
+    {{DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::NorS,   DType::None},
+     {DType::Number}},
+    {{DType::Number, DType::None,   DType::Number},
+     {DType::Number}},
+    {{DType::NorS,   DType::None,   DType::NorS},
+     {DType::Number}},
+    {{DType::None,   DType::Number, DType::Number},
+     {DType::Number}},
+    {{DType::None,   DType::NorS,   DType::NorS},
+     {DType::Number}}
+};
+
+constexpr DataPair ioY[] = {
+    {{DType::Number},
+     {DType::String}},
+    {{DType::String},
+     {DType::Number}},
+    {{DType::Input},
+     {DType::Output}},
+    {{DType::Output},
+     {DType::Input}}
+};
+
+constexpr DataPair ioV[] = {
+    {{DType::Any},
+     {DType::Any}}
+};
+
+constexpr DataPair ioX[] = {
+    {{DType::Any,  DType::None, DType::None, DType::Any},
+     {}},
+    {{DType::Any},
+     {}},
+    {{DType::None, DType::None, DType::None, DType::Any},
+     {}}
+};
+
+constexpr DataPair ioT[] = {
+    {{DType::Any},
+     {DType::Number}}
+};
+
+constexpr DataPair ioH[] = {
+    {{DType::Any},
+     {}}
+};
+
+// The rules are matched against every signature once, so that matching them on every evaluation is a
+// single lookup.
+struct RuleTable {
+    std::uint8_t rules[Operator::signatures];
+};
+
+constexpr bool conforms(DType requirement, std::size_t kind) {
+    return (requirement == DType::None) || check(requirement, typeOfKind(kind));
+}
 
-    switch (code) {
-        case Operator::Code::W:
-            switch (n) {
-                case 0:
-                    interpreter->output(interpreter->getInputString());
-                    break;
-                case 1:
-                    interpreter->output(up.data.toS());
-                    break;
-                case 2:
-                    result.down.data.string = interpreter->getInputString();
-                    break;
-            }
-            break;
-        case Operator::Code::w:
-            switch (n) {
-                case 0:
-                    interpreter->output(interpreter->getInputNumber());
-                    break;
-                case 1:
-                    interpreter->output(up.data.toS());
-                    break;
-                case 2:
-                    result.down.data.number = interpreter->getInputNumber();
-                    break;
-            }
-            break;
-        case Operator::Code::C:
-            if (n <= 3) {
-                result.up = up;
-                result.up.data.direction = util::invert(result.up.data.direction);
-            }
-            if ((n == 0) || (n == 1) || (n == 4) || (n == 5)) {
-                result.left = left;
-                if (result.left.data.direction == util::Dir::Right) {
-                    result.left.data.direction = util::invert(result.left.data.direction);
-                }
-            }
-            if ((n == 0) || (n == 2) || (n == 4) || (n == 6)) {
-                result.right = right;
-                if (result.right.data.direction == util::Dir::Left) {
-                    result.right.data.direction = util::invert(result.right.data.direction);
-                }
-            }
-            break;
-        case Operator::Code::A:
-            switch (n) {
-                case 0:
-                    result.down.data.number = up.data.number + left.data.number + right.data.number;
-                    break;
-                case 1:
-                    result.down.data.string = up.data.toS() + left.data.toS() + right.data.toS();
-                    break;
-                case 2:
-                    result.down.data.number = up.data.number + left.data.number;
-                    break;
-                case 3:
-                    result.down.data.string = up.data.toS() + left.data.toS();
-                    break;
-                case 4:
-                    result.down.data.number = up.data.number + right.data.number;
-                    break;
-                case 5:
-                    result.down.data.string = up.data.toS() + right.data.toS();
-                    break;
-                case 6:
-                    result.down.data.number = left.data.number + right.data.number;
-                    break;
-                case 7:
-                    result.down.data.string = left.data.toS() + right.data.toS();
-                    break;
-            }
-            break;
-        case Operator::Code::S:
-            switch (n) {
-                case 0:
-                    result.down.data.number = up.data.number - left.data.number - right.data.number;
-                    break;
-                case 1:
-                    result.down.data.string = removeString(removeString(up.data.toS(), left.data.toS()), right.data.toS());
-                    break;
-                case 2:
-                    result.down.data.number = up.data.number - left.data.number;
-                    break;
-                case 3:
-                    result.down.data.string = removeString(up.data.toS(), left.data.toS());
-                    break;
-                case 4:
-                    result.down.data.number = up.data.number - right.data.number;
-                    break;
-                case 5:
-                    result.down.data.string = removeString(up.data.toS(), right.data.toS());
-                    break;
-                case 6:
-                    result.down.data.number = left.data.number - right.data.number;
-                    break;
-                case 7:
-                    result.down.data.string = removeString(left.data.toS(), right.data.toS());
-                    break;
-            }
-            break;
-        case Operator::Code::M:
-            switch (n) {
-                case 0:
-                    result.down.data.number = up.data.number * left.data.number * right.data.number;
-                    break;
-                case 1:
-                    result.down.data.string = repeatString(up, left, right, result.success);
-                    break;
-                case 2:
-                    result.down.data.number = up.data.number * left.data.number;
-                    break;
-                case 3:
-                    result.down.data.string = repeatString(up, left, result.success);
-                    break;
-                case 4:
-                    result.down.data.number = up.data.number * right.data.number;
-                    break;
-                case 5:
-                    result.down.data.string = repeatString(up, right, result.success);
-                    break;
-                case 6:
-                    result.down.data.number = left.data.number * right.data.number;
-                    break;
-                case 7:
-                    result.down.data.string = repeatString(left, right, result.success);
-                    break;
-            }
-            break;
-        case Operator::Code::D:
-            switch (n) {
-                case 0:
-                    if ((left.data.number == 0) || (right.data.number == 0))
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number / left.data.number / right.data.number;
-                    break;
-                case 1:
-                    if (left.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number / left.data.number;
-                    break;
-                case 2:
-                    if (right.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number / right.data.number;
-                    break;
-                case 3:
-                    if (right.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = left.data.number / right.data.number;
-                    break;
-                case 4:
-                    cutString(up.data.string, left.data.number, result.down.data.string, result.right.data.string);
-                    break;
-                case 5:
-                    cutString(up.data.string, left.data.string, result.down.data.string, result.right.data.string);
-                    break;
-            }
-            break;
-        case Operator::Code::R:
-            switch (n) {
-                case 0:
-                    if ((left.data.number == 0) || (right.data.number == 0))
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number % left.data.number % right.data.number;
-                    break;
-                case 1:
-                    result.down.data.string = replaceString(up.data.toS(), left.data.toS(), right.data.toS());
-                    break;
-                case 2:
-                    if (left.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number % left.data.number;
-                    break;
-                case 3:
-                    if (right.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = up.data.number % right.data.number;
-                    break;
-                case 4:
-                    if (right.data.number == 0)
-                        result.success = false;
-                    else
-                        result.down.data.number = left.data.number % right.data.number;
-                    break;
-            }
-            break;
-        case Operator::Code::F:
-            switch (n) {
-                case 0:
-                    result.down.data.number = gcd(up.data.number, left.data.number);
-                    break;
-                case 1:
-                    result.down.data.number = find(up.data.toS(), left.data.toS());
-                    break;
-            }
-            break;
-        case Operator::Code::E:
-            switch (n) {
-                case 0:
-                    result.down.data.number = (up.data == left.data) && (up.data == right.data);
-                    break;
-                case 1:
-                    result.down.data.number = up.data == left.data;
-                    break;
-                case 2:
-                    result.down.data.number = up.data == right.data;
-                    break;
-                case 3:
-                    result.down.data.number = left.data == right.data;
-                    break;
-            }
-            break;
-        case Operator::Code::G:
-            switch (n) {
-                case 0:
-                    result.down.data.number = (up.data.number > left.data.number) && (left.data.number > right.data.number);
-                    break;
-                case 1:
-                    result.down.data.number = (up.data.toS() > left.data.toS()) && (left.data.toS() > right.data.toS());
-                    break;
-                case 2:
-                    result.down.data.number = up.data.number > left.data.number;
-                    break;
-                case 3:
-                    result.down.data.number = up.data.toS() > left.data.toS();
-                    break;
-                case 4:
-                    result.down.data.number = up.data.number > right.data.number;
-                    break;
-                case 5:
-                    result.down.data.number = up.data.toS() > right.data.toS();
-                    break;
-                case 6:
-                    result.down.data.number = left.data.number > right.data.number;
-                    break;
-                case 7:
-                    result.down.data.number = left.data.toS() > right.data.toS();
-                    break;
-            }
-            break;
-        case Operator::Code::V:
-            result.down = up;
-            break;
-        case Operator::Code::T:
-            if (up.data.empty()) {
-                result.down = Object();
-            } else {
-                result.down.data.number = interpreter->tick;
-            }
-            break;
-        case Operator::Code::H:
-            if (!up.data.empty()) {
-                interpreter->halt();
+template <std::size_t N>
+constexpr RuleTable allRules(const DataPair (&io)[N]) {
+    RuleTable table{};
+    for (std::size_t signature = 0; signature < Operator::signatures; ++signature) {
+        std::size_t up = signature % dataKinds;
+        std::size_t left = signature / dataKinds % dataKinds;
+        std::size_t right = signature / (dataKinds * dataKinds) % dataKinds;
+        std::size_t down = signature / (dataKinds * dataKinds * dataKinds);
+
+        table.rules[signature] = Operator::noRule;
+        for (std::size_t n = 0; n < N; ++n) {
+            const Operator::DataRequirements &req = io[n].req;
+            if (conforms(req.up, up) && conforms(req.left, left) && conforms(req.right, right) && conforms(req.down, down)) {
+                table.rules[signature] = static_cast<std::uint8_t>(n);
+                break;
             }
-            break;
-        case Operator::Code::h:
-            if (!up.data.empty()) {
-                interpreter->halt(true);
+        }
+    }
+    return table;
+}
+
+template <std::size_t N>
+constexpr RuleTable axisRules(const DataPair (&io)[N]) {
+    RuleTable table{};
+    for (std::size_t signature = 0; signature < Operator::signatures; ++signature) {
+        std::size_t first = signature % dataKinds;
+        std::size_t second = signature / dataKinds;
+
+        table.rules[signature] = Operator::noRule;
+        for (std::size_t n = 0; (n < N) && (second < dataKinds); ++n) {
+            if (conforms(io[n].req.up, first) && conforms(io[n].req.down, second)) {
+                table.rules[signature] = static_cast<std::uint8_t>(n);
+                break;
             }
-            break;
-        default:
-            assert(false);
+        }
     }
+    return table;
+}
 
-    return result;
+constexpr RuleTable rulesW = allRules(ioW);
+constexpr RuleTable rulesw = allRules(iow);
+constexpr RuleTable rulesC = allRules(ioC);
+constexpr RuleTable rulesc = axisRules(ioc);
+constexpr RuleTable rulesSameType = axisRules(ioSameType);
+constexpr RuleTable rulesArithmetic = allRules(ioArithmetic);
+constexpr RuleTable rulesD = allRules(ioD);
+constexpr RuleTable rulesR = allRules(ioR);
+constexpr RuleTable rulesF = allRules(ioF);
+constexpr RuleTable rulesP = axisRules(ioP);
+constexpr RuleTable rulesN = axisRules(ioN);
+constexpr RuleTable rulesE = allRules(ioE);
+constexpr RuleTable rulesG = allRules(ioG);
+constexpr RuleTable rulesY = axisRules(ioY);
+constexpr RuleTable rulesV = allRules(ioV);
+constexpr RuleTable rulesX = axisRules(ioX);
+constexpr RuleTable rulesT = allRules(ioT);
+constexpr RuleTable rulesH = allRules(ioH);
+
+// The handlers decide whether the rules are applied to each axis separately.
+template <std::size_t N>
+constexpr Operator::Descriptor describe(const DataPair (&io)[N], const RuleTable &rules, const AllHandler (&handlers)[N], bool replace = false, bool pure = true) {
+    return {io, N, rules.rules, handlers, nullptr, false, replace, pure};
 }
 
-Result Operator::processAxis(std::size_t n, Object &first, Object &second) {
-    Result result;
-    result.success = true;
+template <std::size_t N>
+constexpr Operator::Descriptor describe(const DataPair (&io)[N], const RuleTable &rules, const AxisHandler (&handlers)[N], bool replace = false, bool pure = true) {
+    return {io, N, rules.rules, nullptr, handlers, true, replace, pure};
+}
 
-    setType(io[n].out.down, result.second);
-    setType(io[n].out.up,   result.first);
+// Indexed by Operator::Code.
+constexpr Operator::Descriptor descriptors[] = {
+    describe(ioW, rulesW, handlersW, false, false),                 // W
+    describe(iow, rulesw, handlersw, false, false),                 // w
+    describe(ioC, rulesC, handlersC, true),                         // C
+    describe(ioc, rulesc, handlersc, true),                         // c
+    describe(ioSameType, rulesSameType, handlersL),                 // L
+    describe(ioSameType, rulesSameType, handlersU),                 // U
+    describe(ioArithmetic, rulesArithmetic, handlersA),             // A
+    describe(ioArithmetic, rulesArithmetic, handlersS),             // S
+    describe(ioArithmetic, rulesArithmetic, handlersM),             // M
+    describe(ioD, rulesD, handlersD),                               // D
+    describe(ioR, rulesR, handlersR),                               // R
+    describe(ioF, rulesF, handlersF),                               // F
+    describe(ioP, rulesP, handlersP),                               // P
+    describe(ioSameType, rulesSameType, handlersZ),                 // Z
+    describe(ioN, rulesN, handlersN),                               // N
+    describe(ioE, rulesE, handlersE),                               // E
+    describe(ioG, rulesG, handlersG),                               // G
+    describe(ioSameType, rulesSameType, handlersK, false, false),   // K
+    describe(ioY, rulesY, handlersY),                               // Y
+    describe(ioV, rulesV, handlersV),                               // V
+    describe(ioX, rulesX, handlersX),                               // X
+    describe(ioT, rulesT, handlersT, false, false),                 // T
+    describe(ioH, rulesH, handlersH, false, false),                 // H
+    describe(ioH, rulesH, handlersh, false, false)                  // h
+};
 
-    switch (code) {
-        case Operator::Code::c:
-            result.first = second;
-            result.second = first;
-            break;
-        case Operator::Code::L:
-            switch (n) {
-                case 0:
-                    result.second.data.number = std::abs(first.data.number);
-                    break;
-                case 1:
-                    result.second.data.string = toLower(first.data.string);
-                    break;
-            }
-            break;
-        case Operator::Code::U:
-            switch (n) {
-                case 0:
-                    result.second.data.number = sign(first.data.number);
-                    break;
-                case 1:
-                    result.second.data.string = toUpper(first.data.string);
-                    break;
-            }
-            break;
-        case Operator::Code::P:
-            switch (n) {
-                case 0:
-                    result.second.data.number = isPrime(first.data.number);
-                    break;
-                case 1:
-                    result.second.data.number = static_cast<Number>(first.data.string.size());
-                    break;
-            }
-            break;
-        case Operator::Code::Z:
-            switch (n) {
-                case 0:
-                    result.second.data.number = reverse(first.data.number);
-                    break;
-                case 1:
-                    result.second.data.string = reverse(first.data.string);
-                    break;
-            }
-            break;
-        case Operator::Code::N:
-            result.second.data.number = first.data.empty();
-            break;
-        case Operator::Code::K:
-            switch (n) {
-                case 0:
-                    result.second.data.number = interpreter->rand(first.data.number);
-                    break;
-                case 1:
-                    if (!first.data.string.empty())
-                        result.second.data.string += first.data.string[interpreter->rand(first.data.string.size())];
-                    break;
-            }
-            break;
-        case Operator::Code::Y:
-            switch (n) {
-                case 0:
-                    result.second.data.string = toString(first.data.number);
-                    break;
-                case 1:
-                    if (!fromString(first.data.string, result.second.data.number))
-                        result.success = false;
-                    break;
-                case 2:
-                case 3:
-                    // nothing to do
-                    break;
-            }
-            break;
-        case Operator::Code::X:
-            // nothing to do
-            break;
-        default:
-            assert(false);
-    }
+}
 
-    return result;
+
+Operator::Host *Operator::host = nullptr;
+
+const Operator::Descriptor &Operator::getDescriptor() const {
+    return descriptors[static_cast<std::size_t>(code)];
 }
 
-Result Operator::processFromPipe(const Object &obj) {
-    Result result;
+void Operator::processAll(std::size_t n, Result &result, const Data &up, const Data &left, const Data &right) const {
     result.success = true;
+    getDescriptor().allHandlers[n](result, up, left, right);
+}
 
+void Operator::processAxis(std::size_t n, Result &result, const Data &first, const Data &second) const {
+    result.success = true;
+    getDescriptor().axisHandlers[n](result, first, second);
+}
+
+bool Operator::processFromPipe(const Object &obj, Object &out) const {
     switch (code) {
         case Operator::Code::V:
-            result.down = obj;
+            out = obj;
             break;
         case Operator::Code::X:
             // nothing to do
             break;
         case Operator::Code::T:
-            if (obj.data.empty()) {
-                result.down = Object();
-            } else {
-                result.down.type = Object::Type::Data;
-                result.down.data.type = Data::Type::Number;
-                result.down.data.number = interpreter->tick;
-            }
+            if (!obj.data.empty())
+                setNumber(out, host->getTick());
             break;
         case Operator::Code::H:
             if (!obj.data.empty()) {
-                interpreter->halt();
+                host->halt(false);
             }
             break;
         case Operator::Code::h:
             if (!obj.data.empty()) {
-                interpreter->halt(true);
+                host->halt(true);
             }
             break;
         default:
             assert(false);
     }
 
-    return result;
+    return true;
 }
@@ -20,20 +20,37 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #pragma once
 
 #include "Data.h"
-#include <vector>
+#include "Number.h"
+#include "SharedString.h"
+#include <cstdint>
+#include <string>
 
-class Interpreter;
 class Object;
 struct Result;
 
 class Operator {
 public:
+    // What the rules use besides the data: the input and the output, random numbers, the tick and
+    // halting. Implemented by the interpreter and by the programs compiled with roopc.
+    class Host {
+    public:
+        virtual std::string getInputString() = 0;
+        virtual Number getInputNumber() = 0;
+        virtual void output(const std::string &s) = 0;
+        virtual void output(const SharedString &s) = 0;
+        virtual void output(Number n) = 0;
+        virtual void halt(bool print) = 0;
+        virtual Number rand(Number n) = 0;
+        virtual Number getTick() = 0;
+    protected:
+        ~Host() = default;
+    };
     struct DataRequirements {
         Data::Type up;
         Data::Type left;
         Data::Type right;
         Data::Type down;
-        DataRequirements(Data::Type up = Data::Type::None, Data::Type left = Data::Type::None, Data::Type right = Data::Type::None, Data::Type down = Data::Type::None):
+        constexpr DataRequirements(Data::Type up = Data::Type::None, Data::Type left = Data::Type::None, Data::Type right = Data::Type::None, Data::Type down = Data::Type::None):
             up(up), left(left), right(right), down(down) {}
     };
     struct DataOutcome {
@@ -41,32 +58,57 @@ public:
         Data::Type right;
         Data::Type left;
         Data::Type up;
-        DataOutcome(Data::Type down = Data::Type::None, Data::Type right = Data::Type::None, Data::Type left = Data::Type::None, Data::Type up = Data::Type::None):
+        constexpr DataOutcome(Data::Type down = Data::Type::None, Data::Type right = Data::Type::None, Data::Type left = Data::Type::None, Data::Type up = Data::Type::None):
             down(down), right(right), left(left), up(up) {}
     };
     struct DataPair {
         DataRequirements req;
         DataOutcome out;
     };
-    using InAndOut = std::vector<DataPair>;
-    enum class Code {W, w, C, c, L, U, A, S, M, D, R, F, P, Z,
-                     N, E, G, K, Y,
-                     V, X, T, H, h
-                    };
+    // Write the outcome of a rule into result. An operator whose rules are applied to each axis gets the
+    // data of the axis, the others get up, left and right (the data below is never an input).
+    using AllHandler = void (*)(Result &result, const Data &up, const Data &left, const Data &right);
+    using AxisHandler = void (*)(Result &result, const Data &first, const Data &second);
+    // The kinds of the data around an operator (see kindOf) are combined in a signature: up + left * 5 +
+    // right * 25 + down * 125, or first + second * 5 for an axis.
+    static const std::size_t signatures = dataKinds * dataKinds * dataKinds * dataKinds;
+    static const std::uint8_t noRule = 0xFF;
+    // Rules of an operator, shared by all the cells with the same code.
+    struct Descriptor {
+        const DataPair *io;
+        std::size_t size;
+        // First rule that matches each signature, or noRule.
+        const std::uint8_t *rules;
+        // One for each rule, only allHandlers or axisHandlers (if separateAxes) is set.
+        const AllHandler *allHandlers;
+        const AxisHandler *axisHandlers;
+        // If separateAxes is true only 'up' and 'down' are used in the requirements and outcome (the others must be None),
+        // although in fact both are going to be applied separately to the pairs up-down and left-right.
+        bool separateAxes;
+        bool replace;
+        // The rules only compute their results from the data (no input, output, random numbers, tick
+        // or halting), so they can be evaluated in any order and from any thread.
+        bool pure;
+    };
+    enum class Code : std::uint8_t {W, w, C, c, L, U, A, S, M, D, R, F, P, Z,
+                                    N, E, G, K, Y,
+                                    V, X, T, H, h
+                                   };
+
+    // Evaluate rule n into result, which may still hold an older outcome: only success and the objects
+    // of the outcome of the rule are written.
+    void processAll(std::size_t n, Result &result, const Data &up, const Data &left, const Data &right) const;
+    void processAxis(std::size_t n, Result &result, const Data &first, const Data &second) const;
+    // Sets out to what the operator sends on when obj reaches it through a pipe (it stays Empty if
+    // nothing is sent), returns false if the operator fails.
+    bool processFromPipe(const Object &obj, Object &out) const;
 
-    Result processAll(std::size_t n, Object &up, Object &left, Object &right, Object &down);
-    Result processAxis(std::size_t n, Object &first, Object &second);
-    Result processFromPipe(const Object &obj);
+    const Descriptor &getDescriptor() const;
 
-    static Interpreter *interpreter;
+    static Host *host;
 
     Code code;
     bool noRemove;
-    InAndOut io;
-    // If separateAxes is true only 'up' and 'down' are used in the requirements and outcome (the others must be None),
-    // although in fact both are going to be applied separately to the pairs up-down and left-right.
-    bool separateAxes = false;
-    bool replace = false;
 private:
 
 };
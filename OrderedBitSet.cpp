@@ -0,0 +1,57 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "OrderedBitSet.h"
+
+void OrderedBitSet::resize(std::size_t size) {
+    levels.clear();
+    do {
+        size = (size + 63) / 64;
+        levels.emplace_back(size, 0);
+    } while (size > 1);
+}
+
+std::size_t OrderedBitSet::next(std::size_t i) const {
+    // Go up until a word has a bit set at or after the position...
+    std::size_t level = 0;
+    while (true) {
+        std::size_t word = i / 64;
+        if (word >= levels[level].size())
+            return none;
+
+        std::uint64_t bits = levels[level][word] & (~std::uint64_t(0) << (i % 64));
+        if (bits != 0) {
+            i = word * 64 + util::lowestBit(bits);
+            break;
+        }
+
+        if (level + 1 == levels.size())
+            return none;
+        i = word + 1;
+        ++level;
+    }
+
+    // ...and then down following the first bit set of each word.
+    while (level > 0) {
+        --level;
+        i = i * 64 + util::lowestBit(levels[level][i]);
+    }
+
+    return i;
+}
@@ -0,0 +1,70 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of indices in [0, size) that finds the first one after a position in a few word operations.
+// It is a tree of bitmaps: the first level has one bit per index and every other one a bit per word
+// of the level below that is not 0.
+class OrderedBitSet {
+public:
+    static const std::size_t none = static_cast<std::size_t>(-1);
+
+    // Also removes all the indices.
+    void resize(std::size_t size);
+
+    bool contains(std::size_t i) const;
+    void insert(std::size_t i);
+    void erase(std::size_t i);
+    // Smallest index in the set that is not less than i, or none.
+    std::size_t next(std::size_t i) const;
+private:
+    std::vector<std::vector<std::uint64_t>> levels;
+};
+
+inline bool OrderedBitSet::contains(std::size_t i) const {
+    return (levels[0][i / 64] >> (i % 64)) & 1;
+}
+
+inline void OrderedBitSet::insert(std::size_t i) {
+    for (std::vector<std::uint64_t> &level : levels) {
+        std::uint64_t &word = level[i / 64];
+        bool wasEmpty = (word == 0);
+        word |= std::uint64_t(1) << (i % 64);
+        if (!wasEmpty)
+            return;
+        i /= 64;
+    }
+}
+
+inline void OrderedBitSet::erase(std::size_t i) {
+    for (std::vector<std::uint64_t> &level : levels) {
+        std::uint64_t &word = level[i / 64];
+        word &= ~(std::uint64_t(1) << (i % 64));
+        if (word != 0)
+            return;
+        i /= 64;
+    }
+}
@@ -0,0 +1,471 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+#include "PipeRoutes.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+std::size_t towards(const Grid &grid, std::size_t i, util::Dir dir) {
+    switch (dir) {
+        case util::Dir::Up:
+            return i - grid.getWidth();
+        case util::Dir::Down:
+            return i + grid.getWidth();
+        case util::Dir::Left:
+            return i - 1;
+        default:
+            return i + 1;
+    }
+}
+
+std::size_t key(std::size_t i, util::Dir dir) {
+    return i * 4 + static_cast<std::size_t>(dir);
+}
+
+}
+
+PipeRoutes::PipeRoutes() {
+    clear();
+}
+
+void PipeRoutes::clear() {
+    steps.clear();
+    entries.clear();
+    pending.clear();
+    running.clear();
+    loops = 0;
+    teleportRows.clear();
+    teleportColumns.clear();
+    teleportRoutes = 0;
+    unpairedTeleports = 0;
+    // The first step is the failure shared by all the routes.
+    add(Step::Kind::Fail);
+}
+
+void PipeRoutes::build(const Grid &grid) {
+    clear();
+
+    const std::size_t width = grid.getWidth();
+    const std::size_t height = grid.getHeight();
+    for (std::size_t i = 0; i < width * height; ++i) {
+        if ((grid.type(i) == Object::Type::Pipe) && (grid.pipe(i) == Pipe::Type::Teleport)) {
+            teleportRows.push_back(static_cast<std::uint32_t>(i));
+            teleportColumns.push_back(static_cast<std::uint32_t>((i % width) * height + i / width));
+        }
+    }
+    std::sort(teleportColumns.begin(), teleportColumns.end());
+
+    for (std::size_t i = 0; i < width * height; ++i) {
+        if (!check(grid.type(i), Object::Type::Operator))
+            continue;
+
+        for (util::Dir dir : {util::Dir::Up, util::Dir::Down, util::Dir::Left, util::Dir::Right}) {
+            std::size_t neighbour = towards(grid, i, dir);
+            if ((grid.type(neighbour) == Object::Type::Pipe) || (grid.type(neighbour) == Object::Type::SpecialOperator))
+                compile(grid, neighbour, dir);
+        }
+    }
+
+    link(1);
+    findLoops();
+    running.assign(steps.size(), false);
+}
+
+bool PipeRoutes::send(const Grid &grid, WriteLog &log, const Object &obj, std::size_t i, util::Dir dir) {
+    auto entry = entries.find(key(i, dir));
+    return (entry != entries.end()) && run(grid, log, obj, entry->second);
+}
+
+std::uint32_t PipeRoutes::entry(std::size_t i, util::Dir dir) const {
+    auto entry = entries.find(key(i, dir));
+    return (entry != entries.end()) ? entry->second : 0;
+}
+
+bool PipeRoutes::send(const Grid &grid, WriteLog &log, const Object &obj, std::uint32_t entry) {
+    return run(grid, log, obj, entry);
+}
+
+std::size_t PipeRoutes::getSize() const {
+    return steps.size();
+}
+
+std::size_t PipeRoutes::getLoops() const {
+    return loops;
+}
+
+std::size_t PipeRoutes::getTeleports() const {
+    return teleportRows.size();
+}
+
+std::size_t PipeRoutes::getTeleportRoutes() const {
+    return teleportRoutes;
+}
+
+std::size_t PipeRoutes::getUnpairedTeleports() const {
+    return unpairedTeleports;
+}
+
+// Reserves the steps of the routes in a worklist instead of following the branches of the forks
+// and the results of the special operators right away, so that the stack does not grow with the
+// layout. Every cell gets a step, which is reserved before its route is followed so that a route
+// that comes back to the cell refers to it.
+void PipeRoutes::compile(const Grid &grid, std::size_t i, util::Dir dir) {
+    reserve(i, dir);
+
+    while (!pending.empty()) {
+        Pending route = pending.back();
+        pending.pop_back();
+        follow(grid, route.cell, route.dir, route.step);
+    }
+}
+
+// Step of the route of the objects sent into the cell in the direction, reserved and left in the
+// worklist if there was none.
+std::uint32_t PipeRoutes::reserve(std::size_t i, util::Dir dir) {
+    auto entry = entries.find(key(i, dir));
+    if (entry != entries.end())
+        return entry->second;
+
+    std::uint32_t n = add(Step::Kind::Fail, i);
+    entries.emplace(key(i, dir), n);
+    pending.push_back(Pending{i, dir, n});
+    return n;
+}
+
+// Fills in the reserved step n of the cell and direction, and the ones of the plain pipes that follow
+// it, up to a step that was already reserved or one that ends the route.
+void PipeRoutes::follow(const Grid &grid, std::size_t i, util::Dir dir, std::uint32_t n) {
+    while (true) {
+        if (grid.type(i) != Object::Type::Pipe) {
+            if (grid.type(i) == Object::Type::SpecialOperator) {
+                std::uint32_t place = reservePlace(grid, i + grid.getWidth(), util::Dir::Down);
+                steps[n].kind = Step::Kind::Special;
+                steps[n].next = place;
+            }
+            return;
+        }
+
+        util::Dir to = dir;
+        std::size_t target = 0;
+        switch (grid.pipe(i)) {
+            case Pipe::Type::Horizontal:
+                to = (dir == util::Dir::Left) ? util::Dir::Left : util::Dir::Right;
+                break;
+            case Pipe::Type::Vertical:
+                to = (dir == util::Dir::Up) ? util::Dir::Up : util::Dir::Down;
+                break;
+            case Pipe::Type::Intersection:
+                break;
+            case Pipe::Type::Bouncer:
+                to = util::invert(dir);
+                break;
+            case Pipe::Type::TurnR:
+                if (dir == util::Dir::Up)
+                    to = util::Dir::Right;
+                else if (dir == util::Dir::Left)
+                    to = util::Dir::Up;
+                else if (dir == util::Dir::Right)
+                    to = util::Dir::Down;
+                else
+                    to = util::Dir::Left;
+                break;
+            case Pipe::Type::TurnL:
+                if (dir == util::Dir::Up)
+                    to = util::Dir::Left;
+                else if (dir == util::Dir::Left)
+                    to = util::Dir::Down;
+                else if (dir == util::Dir::Right)
+                    to = util::Dir::Up;
+                else
+                    to = util::Dir::Right;
+                break;
+            case Pipe::Type::Duplicator: {
+                std::uint32_t a;
+                std::uint32_t b;
+                if ((dir == util::Dir::Up) || (dir == util::Dir::Down)) {
+                    a = reserve(i + 1, util::Dir::Right);
+                    b = reserve(i - 1, util::Dir::Left);
+                } else {
+                    a = reserve(i - grid.getWidth(), util::Dir::Up);
+                    b = reserve(i + grid.getWidth(), util::Dir::Down);
+                }
+                steps[n].kind = Step::Kind::Fork;
+                steps[n].next = a;
+                steps[n].other = b;
+                return;
+            }
+            case Pipe::Type::Teleport:
+                ++teleportRoutes;
+                target = findTeleport(grid, i, dir);
+                if (target == 0) {
+                    ++unpairedTeleports;
+                    return;
+                }
+                target = towards(grid, target, dir);
+                break;
+            case Pipe::Type::Eraser:
+                steps[n].kind = Step::Kind::Erase;
+                return;
+        }
+
+        steps[n].kind = Step::Kind::Forward;
+        i = (grid.pipe(i) == Pipe::Type::Teleport) ? target : towards(grid, i, to);
+        dir = to;
+
+        auto entry = entries.find(key(i, dir));
+        if (entry != entries.end()) {
+            steps[n].next = entry->second;
+            return;
+        }
+        std::uint32_t m = add(Step::Kind::Fail, i);
+        entries.emplace(key(i, dir), m);
+        steps[n].next = m;
+        n = m;
+    }
+}
+
+// Cell of the next teleport after the one of the cell in the direction, or 0 (a corner of the border)
+// if there is none. The border is never a teleport, so there is no need to check where it is.
+std::size_t PipeRoutes::findTeleport(const Grid &grid, std::size_t i, util::Dir dir) const {
+    const std::size_t width = grid.getWidth();
+    const std::size_t height = grid.getHeight();
+    const std::size_t x = i % width;
+    const std::size_t y = i / width;
+
+    if ((dir == util::Dir::Left) || (dir == util::Dir::Right)) {
+        auto position = std::lower_bound(teleportRows.begin(), teleportRows.end(), i);
+        if (dir == util::Dir::Right) {
+            ++position;
+            return ((position != teleportRows.end()) && (*position / width == y)) ? *position : 0;
+        }
+        return ((position != teleportRows.begin()) && (*(position - 1) / width == y)) ? *(position - 1) : 0;
+    }
+
+    std::size_t key = x * height + y;
+    auto position = std::lower_bound(teleportColumns.begin(), teleportColumns.end(), key);
+    if (dir == util::Dir::Down) {
+        ++position;
+        return ((position != teleportColumns.end()) && (*position / height == x)) ? grid.index(x, *position % height) : 0;
+    }
+    return ((position != teleportColumns.begin()) && (*(position - 1) / height == x)) ? grid.index(x, *(position - 1) % height) : 0;
+}
+
+// Route of an object placed (not forced) in a cell, like the result of a special operator.
+std::uint32_t PipeRoutes::reservePlace(const Grid &grid, std::size_t i, util::Dir dir) {
+    Object::Type type = grid.type(i);
+
+    if ((type == Object::Type::Pipe) || (type == Object::Type::SpecialOperator))
+        return reserve(i, dir);
+    if ((type == Object::Type::Empty) || (type == Object::Type::Data))
+        return add(Step::Kind::Land, i);
+
+    return 0;
+}
+
+std::uint32_t PipeRoutes::add(Step::Kind kind, std::size_t cell) {
+    steps.push_back(Step{kind, false, static_cast<std::uint32_t>(cell), 0, 0});
+    return static_cast<std::uint32_t>(steps.size() - 1);
+}
+
+// Makes the forward steps from 'from' point directly to the first step of their route that is not
+// a forward, so a route takes a single jump however long the pipes are. Pipes that go round in
+// a circle without reaching anything end in the failure.
+void PipeRoutes::link(std::size_t from) {
+    // 0: not visited, 1: in the chain being followed, 2: linked.
+    std::vector<std::uint8_t> state(steps.size() - from, 0);
+    std::vector<std::uint32_t> chain;
+
+    for (std::size_t k = from; k < steps.size(); ++k) {
+        std::uint32_t n = static_cast<std::uint32_t>(k);
+        chain.clear();
+        while ((steps[n].kind == Step::Kind::Forward) && (n >= from) && (state[n - from] == 0)) {
+            state[n - from] = 1;
+            chain.push_back(n);
+            n = steps[n].next;
+        }
+
+        std::uint32_t target = n;
+        if (steps[n].kind == Step::Kind::Forward)
+            target = ((n >= from) && (state[n - from] == 1)) ? 0 : steps[n].next;
+
+        for (std::uint32_t c : chain) {
+            steps[c].next = target;
+            state[c - from] = 2;
+        }
+    }
+}
+
+// Marks the steps that are part of a circuit through forks or special operators (the strongly connected
+// components of the routes, found with Tarjan's algorithm without recursion).
+void PipeRoutes::findLoops() {
+    const std::uint32_t none = static_cast<std::uint32_t>(-1);
+    std::vector<std::uint32_t> order(steps.size(), none);
+    std::vector<std::uint32_t> low(steps.size(), 0);
+    std::vector<bool> stacked(steps.size(), false);
+    std::vector<std::uint32_t> stack;
+    // Step being visited and number of its successors already visited.
+    std::vector<std::pair<std::uint32_t, int>> visits;
+    std::uint32_t counter = 0;
+
+    auto successor = [&](std::uint32_t n, int k, std::uint32_t &next) -> bool {
+        switch (steps[n].kind) {
+            case Step::Kind::Forward:
+            case Step::Kind::Special:
+                next = steps[n].next;
+                return k == 0;
+            case Step::Kind::Fork:
+                next = (k == 0) ? steps[n].next : steps[n].other;
+                return k < 2;
+            default:
+                return false;
+        }
+    };
+
+    loops = 0;
+    for (std::uint32_t root = 0; root < steps.size(); ++root) {
+        if (order[root] != none)
+            continue;
+
+        visits.emplace_back(root, 0);
+        order[root] = low[root] = counter++;
+        stack.push_back(root);
+        stacked[root] = true;
+
+        while (!visits.empty()) {
+            std::uint32_t n = visits.back().first;
+            std::uint32_t next;
+
+            if (successor(n, visits.back().second++, next)) {
+                if (order[next] == none) {
+                    visits.emplace_back(next, 0);
+                    order[next] = low[next] = counter++;
+                    stack.push_back(next);
+                    stacked[next] = true;
+                } else if (stacked[next]) {
+                    low[n] = std::min(low[n], order[next]);
+                }
+                continue;
+            }
+
+            visits.pop_back();
+            if (!visits.empty())
+                low[visits.back().first] = std::min(low[visits.back().first], low[n]);
+
+            if (low[n] == order[n]) {
+                std::uint32_t m;
+                bool selfLoop = false;
+                for (int k = 0; successor(n, k, m); ++k)
+                    selfLoop = selfLoop || (m == n);
+
+                bool circuit = selfLoop || (stack.back() != n);
+                do {
+                    m = stack.back();
+                    stack.pop_back();
+                    stacked[m] = false;
+                    steps[m].loop = circuit;
+                } while (m != n);
+
+                if (circuit)
+                    ++loops;
+            }
+        }
+    }
+}
+
+// Follows the branches depth first with a stack of visits instead of recursion, in the same order:
+// the first branch of a fork and everything it leads to before the second one, which waits on the
+// stack. The object sent succeeds if any of the branches does.
+bool PipeRoutes::run(const Grid &grid, WriteLog &log, const Object &obj, std::uint32_t n) {
+    const std::size_t base = visits.size();
+    std::uint32_t object = none;
+    bool success = false;
+
+    while (true) {
+        if (steps[n].kind == Step::Kind::Forward)
+            n = steps[n].next;
+
+        bool next = false;
+        if (!steps[n].loop || !running[n]) {
+            if (steps[n].loop) {
+                running[n] = true;
+                visits.push_back(Visit{Visit::Action::Leave, n, none});
+            }
+
+            const Step &step = steps[n];
+            const Object &current = (object == none) ? obj : outputs[object];
+            switch (step.kind) {
+                case Step::Kind::Erase:
+                    success = true;
+                    break;
+                case Step::Kind::Land:
+                    if (log.type(grid, step.cell) == Object::Type::Empty) {
+                        log.write(step.cell, current);
+                        success = true;
+                    }
+                    break;
+                case Step::Kind::Special: {
+                    Object out;
+                    if (!grid.op(step.cell).processFromPipe(current, out))
+                        break;
+                    if (out.type == Object::Type::Empty) {
+                        success = true;
+                        break;
+                    }
+                    outputs.push_back(std::move(out));
+                    visits.push_back(Visit{Visit::Action::Release, 0, none});
+                    object = static_cast<std::uint32_t>(outputs.size() - 1);
+                    n = step.next;
+                    next = true;
+                    break;
+                }
+                case Step::Kind::Fork:
+                    visits.push_back(Visit{Visit::Action::Enter, step.other, object});
+                    n = step.next;
+                    next = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (next)
+            continue;
+
+        // The branch ended: leave what it went through and take the next one waiting.
+        while (visits.size() > base) {
+            Visit visit = visits.back();
+            visits.pop_back();
+            if (visit.action == Visit::Action::Enter) {
+                n = visit.step;
+                object = visit.object;
+                next = true;
+                break;
+            }
+            if (visit.action == Visit::Action::Leave)
+                running[visit.step] = false;
+            else
+                outputs.pop_back();
+        }
+        if (!next)
+            break;
+    }
+
+    return success;
+}
@@ -0,0 +1,120 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+#pragma once
+
+#include "Grid.h"
+#include "Object.h"
+#include "Util.h"
+#include "WriteLog.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Routes followed by the objects sent into pipes, built from the layout of the grid when it is loaded.
+// Pipes and operators never change, so the only thing that depends on the tick is where a route ends:
+// a cell where the object lands if it is still empty, or a special operator.
+class PipeRoutes {
+public:
+    PipeRoutes();
+
+    void clear();
+    // Builds the routes that start next to the operators, the only places where objects are sent from.
+    void build(const Grid &grid);
+    // Sends the object into the pipe or special operator of the cell, in the given direction. An object
+    // that comes back to a part of its route that it has not left yet is lost instead of going round
+    // forever.
+    bool send(const Grid &grid, WriteLog &log, const Object &obj, std::size_t i, util::Dir dir);
+    // First step of the route of the objects sent into the cell in the given direction, the failure
+    // if the route was not built, and the same send() from it.
+    std::uint32_t entry(std::size_t i, util::Dir dir) const;
+    bool send(const Grid &grid, WriteLog &log, const Object &obj, std::uint32_t entry);
+
+    std::size_t getSize() const;
+    // Number of closed circuits found in the routes.
+    std::size_t getLoops() const;
+    std::size_t getTeleports() const;
+    // Routes that go through a teleport, and the ones among them that find no other teleport.
+    std::size_t getTeleportRoutes() const;
+    std::size_t getUnpairedTeleports() const;
+private:
+    struct Step {
+        enum class Kind : std::uint8_t {Fail, Erase, Land, Special, Fork, Forward};
+
+        Kind kind;
+        // The step is part of a circuit.
+        bool loop;
+        // Cell where the object lands or of the special operator.
+        std::uint32_t cell;
+        // Route of the result of a special operator, first branch of a fork or step that follows
+        // a forward.
+        std::uint32_t next;
+        // Second branch of a fork.
+        std::uint32_t other;
+    };
+
+    // Route of a cell and direction whose step is reserved but not filled in yet.
+    struct Pending {
+        std::size_t cell;
+        util::Dir dir;
+        std::uint32_t step;
+    };
+
+    // Entry of the stack of run(): a branch waiting to be followed, a circuit to leave or a result of
+    // a special operator to drop.
+    struct Visit {
+        enum class Action : std::uint8_t {Enter, Leave, Release};
+
+        Action action;
+        std::uint32_t step;
+        // Object that follows the step, in the results of the special operators or none for the one
+        // sent.
+        std::uint32_t object;
+    };
+
+    static const std::uint32_t none = static_cast<std::uint32_t>(-1);
+
+    void compile(const Grid &grid, std::size_t i, util::Dir dir);
+    std::uint32_t reserve(std::size_t i, util::Dir dir);
+    std::uint32_t reservePlace(const Grid &grid, std::size_t i, util::Dir dir);
+    void follow(const Grid &grid, std::size_t i, util::Dir dir, std::uint32_t n);
+    std::uint32_t add(Step::Kind kind, std::size_t cell = 0);
+    std::size_t findTeleport(const Grid &grid, std::size_t i, util::Dir dir) const;
+    void link(std::size_t from);
+    void findLoops();
+    bool run(const Grid &grid, WriteLog &log, const Object &obj, std::uint32_t n);
+
+    std::vector<Step> steps;
+    // First step of the route of each pair of cell and direction.
+    std::unordered_map<std::size_t, std::uint32_t> entries;
+    // Worklist of compile().
+    std::vector<Pending> pending;
+    // Steps of circuits that an object is going through.
+    std::vector<bool> running;
+    // Stack of run() and the results of the special operators on it.
+    std::vector<Visit> visits;
+    std::vector<Object> outputs;
+    std::size_t loops = 0;
+    // Cells of the teleports in the order of the rows, and positions of the teleports in the order of
+    // the columns (x * height + y), to find the next one in any direction with a binary search.
+    std::vector<std::uint32_t> teleportRows;
+    std::vector<std::uint32_t> teleportColumns;
+    std::size_t teleportRoutes = 0;
+    std::size_t unpairedTeleports = 0;
+};
@@ -0,0 +1,404 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "Primes.h"
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Numbers below sieveLimit are looked up in segments of segmentSize numbers, with one bit for each
+// odd number. A segment is sieved the first time one of its numbers is asked for and never changes
+// once published, so reading it only takes an acquire load of its pointer.
+const std::uint64_t segmentSize = 1 << 18;
+const std::size_t segmentCount = 64;
+const std::uint64_t sieveLimit = segmentSize * segmentCount;
+
+struct Segment {
+    std::uint64_t bits[segmentSize / 128];
+};
+
+std::atomic<const Segment *> segments[segmentCount];
+std::unique_ptr<Segment> ownedSegments[segmentCount];
+std::mutex segmentMutex;
+// Odd primes up to the square root of sieveLimit.
+std::vector<std::uint32_t> basePrimes;
+
+const Segment *buildSegment(std::size_t index) {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+
+    if (const Segment *segment = segments[index].load(std::memory_order_relaxed))
+        return segment;
+
+    if (basePrimes.empty()) {
+        const std::uint32_t limit = 1 << 12;
+        std::vector<bool> composite(limit + 1, false);
+        for (std::uint32_t i = 3; i <= limit; i += 2) {
+            if (!composite[i]) {
+                basePrimes.push_back(i);
+                for (std::uint32_t j = i * i; j <= limit; j += 2 * i)
+                    composite[j] = true;
+            }
+        }
+    }
+
+    std::unique_ptr<Segment> segment(new Segment());
+    for (std::uint64_t &word : segment->bits)
+        word = ~0ull;
+
+    // Bit b of the segment stands for start + 2 * b + 1.
+    std::uint64_t start = index * segmentSize;
+    std::uint64_t end = start + segmentSize;
+    for (std::uint32_t p : basePrimes) {
+        std::uint64_t multiple = static_cast<std::uint64_t>(p) * p;
+        if (multiple >= end)
+            break;
+        if (multiple < start) {
+            multiple = (start + p - 1) / p * p;
+            if (multiple % 2 == 0)
+                multiple += p;
+        }
+        for (; multiple < end; multiple += 2 * p) {
+            std::uint64_t bit = (multiple - start) / 2;
+            segment->bits[bit / 64] &= ~(1ull << (bit % 64));
+        }
+    }
+    if (index == 0)
+        segment->bits[0] &= ~1ull;
+
+    const Segment *published = segment.get();
+    ownedSegments[index] = std::move(segment);
+    segments[index].store(published, std::memory_order_release);
+    return published;
+}
+
+// High and low halves of the 128-bit product of a and b.
+std::uint64_t multiplyWide(std::uint64_t a, std::uint64_t b, std::uint64_t &low) {
+#if defined(_MSC_VER)
+    std::uint64_t high;
+    low = _umul128(a, b, &high);
+    return high;
+#else
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    low = static_cast<std::uint64_t>(product);
+    return static_cast<std::uint64_t>(product >> 64);
+#endif
+}
+
+// Arithmetic modulo an odd n in Montgomery form (x is kept as x * 2^64 mod n), so that the
+// products are reduced with multiplications instead of 128-bit divisions.
+class Montgomery {
+public:
+    explicit Montgomery(std::uint64_t n): n(n) {
+        // Newton's iteration doubles the correct low bits of the inverse of n modulo 2^64 each time.
+        inverse = n;
+        for (int i = 0; i < 5; ++i)
+            inverse *= 2 - n * inverse;
+
+        one = (0 - n) % n;
+        std::uint64_t low;
+        std::uint64_t high = multiplyWide(one, one, low);
+#if defined(_MSC_VER)
+        _udiv128(high, low, n, &square);
+#else
+        square = static_cast<std::uint64_t>(((static_cast<unsigned __int128>(high) << 64) | low) % n);
+#endif
+    }
+
+    std::uint64_t getOne() const {
+        return one;
+    }
+
+    std::uint64_t getMinusOne() const {
+        return n - one;
+    }
+
+    std::uint64_t convert(std::uint64_t x) const {
+        return multiply(x % n, square);
+    }
+
+    std::uint64_t multiply(std::uint64_t a, std::uint64_t b) const {
+        std::uint64_t low;
+        std::uint64_t high = multiplyWide(a, b, low);
+        std::uint64_t ignored;
+        std::uint64_t correction = multiplyWide(low * inverse, n, ignored);
+        return (high >= correction) ? high - correction : high - correction + n;
+    }
+
+    std::uint64_t power(std::uint64_t base, std::uint64_t exponent) const {
+        std::uint64_t result = one;
+        while (exponent != 0) {
+            if (exponent & 1)
+                result = multiply(result, base);
+            base = multiply(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+private:
+    std::uint64_t n;
+    std::uint64_t inverse;
+    // 2^64 and 2^128 modulo n.
+    std::uint64_t one;
+    std::uint64_t square;
+};
+
+// Deterministic for every odd n above 61: the bases 2, 7 and 61 decide all the values below 2^32
+// and the first twelve primes all the values below 2^64.
+bool millerRabin(std::uint64_t n) {
+    static const std::uint64_t smallBases[] = {2, 7, 61};
+    static const std::uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+    for (std::uint64_t base : bases) {
+        if (n % base == 0)
+            return false;
+    }
+
+    std::uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++s;
+    }
+
+    Montgomery montgomery(n);
+    std::uint64_t one = montgomery.getOne();
+    std::uint64_t minusOne = montgomery.getMinusOne();
+
+    bool small = n < (1ull << 32);
+    const std::uint64_t *first = small ? std::begin(smallBases) : std::begin(bases);
+    const std::uint64_t *last = small ? std::end(smallBases) : std::end(bases);
+    for (const std::uint64_t *base = first; base != last; ++base) {
+        std::uint64_t x = montgomery.power(montgomery.convert(*base), d);
+        if ((x == one) || (x == minusOne))
+            continue;
+
+        bool composite = true;
+        for (int r = 1; r < s; ++r) {
+            x = montgomery.multiply(x, x);
+            if (x == minusOne) {
+                composite = false;
+                break;
+            }
+        }
+        if (composite)
+            return false;
+    }
+
+    return true;
+}
+}
+
+bool isPrime(std::uint64_t n) {
+    if (n % 2 == 0)
+        return n == 2;
+
+    if (n < sieveLimit) {
+        std::size_t index = static_cast<std::size_t>(n / segmentSize);
+        const Segment *segment = segments[index].load(std::memory_order_acquire);
+        if (!segment)
+            segment = buildSegment(index);
+
+        std::uint64_t bit = (n % segmentSize) / 2;
+        return (segment->bits[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    return millerRabin(n);
+}
+
+#ifdef ROOP_BIG_NUMBERS
+namespace {
+
+const BigNumber limbBase = BigNumber(1) * 4294967296LL;
+
+// x modulo n, between 0 and n - 1 also for a negative x.
+BigNumber reduce(const BigNumber &x, const BigNumber &n) {
+    BigNumber r = x % n;
+    return (r < 0) ? r + n : r;
+}
+
+// Half of x modulo an odd n, for x between 0 and 2n - 1.
+BigNumber halve(const BigNumber &x, const BigNumber &n) {
+    BigNumber half = ((x % 2 == 0) ? x : x + n) / 2;
+    return (half < n) ? half : half - n;
+}
+
+// Digits of a positive value in base 2^32, the least significant first.
+std::vector<std::uint32_t> limbsOf(BigNumber x) {
+    std::vector<std::uint32_t> limbs;
+    while (x != 0) {
+        limbs.push_back(static_cast<std::uint32_t>(static_cast<long long>(x % limbBase)));
+        x /= limbBase;
+    }
+    return limbs;
+}
+
+// Bits of a positive value, the most significant first.
+std::vector<bool> bitsOf(const BigNumber &x) {
+    std::vector<std::uint32_t> limbs = limbsOf(x);
+    std::vector<bool> bits;
+    for (auto limb = limbs.rbegin(); limb != limbs.rend(); ++limb) {
+        for (int b = 31; b >= 0; --b) {
+            bool bit = (*limb >> b) & 1;
+            if (bit || !bits.empty())
+                bits.push_back(bit);
+        }
+    }
+    return bits;
+}
+
+BigNumber powerModulo(BigNumber base, const BigNumber &exponent, const BigNumber &n) {
+    BigNumber result = 1;
+    for (bool bit : bitsOf(exponent)) {
+        result = result * result % n;
+        if (bit)
+            result = result * base % n;
+    }
+    return result;
+}
+
+bool isSquare(const BigNumber &n) {
+    // Newton's iteration from a power of two above the square root only goes down.
+    BigNumber x = 1;
+    for (std::size_t i = 0; i < bitsOf(n).size() / 2 + 1; ++i)
+        x *= 2;
+    while (true) {
+        BigNumber y = (x + n / x) / 2;
+        if (y >= x)
+            break;
+        x = y;
+    }
+    return x * x == n;
+}
+
+// Jacobi symbol (a/n) for an odd n above 0.
+int jacobi(BigNumber a, BigNumber n) {
+    a = reduce(a, n);
+    int result = 1;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            BigNumber r = n % 8;
+            if ((r == 3) || (r == 5))
+                result = -result;
+        }
+        std::swap(a, n);
+        if ((a % 4 == 3) && (n % 4 == 3))
+            result = -result;
+        a = a % n;
+    }
+    return (n == 1) ? result : 0;
+}
+
+bool strongProbablePrimeBase2(const BigNumber &n) {
+    BigNumber d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++s;
+    }
+
+    BigNumber x = powerModulo(2, d, n);
+    if ((x == 1) || (x == n - 1))
+        return true;
+    for (int r = 1; r < s; ++r) {
+        x = x * x % n;
+        if (x == n - 1)
+            return true;
+    }
+    return false;
+}
+
+// Strong Lucas test with the parameters of Selfridge: D is the first of 5, -7, 9, -11... with
+// (D/n) = -1, P = 1 and Q = (1 - D) / 4.
+bool strongLucasProbablePrime(const BigNumber &n) {
+    long long d = 5;
+    for (int attempt = 0; ; ++attempt) {
+        int symbol = jacobi(d, n);
+        if (symbol == -1)
+            break;
+        if ((symbol == 0) && (BigNumber(d < 0 ? -d : d) != n))
+            return false;
+        // A square has no such D, so look for one only after a few attempts.
+        if ((attempt == 10) && isSquare(n))
+            return false;
+        d = (d > 0) ? -(d + 2) : -d + 2;
+    }
+    const BigNumber q = (1 - d) / 4;
+
+    BigNumber k = n + 1;
+    int s = 0;
+    while (k % 2 == 0) {
+        k /= 2;
+        ++s;
+    }
+
+    // U(1) = 1, V(1) = P and Q^1, then doubling and adding one for each bit of k.
+    BigNumber u = 1;
+    BigNumber v = 1;
+    BigNumber qk = reduce(q, n);
+    std::vector<bool> bits = bitsOf(k);
+    for (std::size_t i = 1; i < bits.size(); ++i) {
+        u = u * v % n;
+        v = reduce(v * v - 2 * qk, n);
+        qk = qk * qk % n;
+        if (bits[i]) {
+            BigNumber nextU = halve(u + v, n);
+            v = halve(reduce(d * u + v, n), n);
+            u = nextU;
+            qk = reduce(qk * q, n);
+        }
+    }
+
+    if ((u == 0) || (v == 0))
+        return true;
+    for (int r = 1; r < s; ++r) {
+        v = reduce(v * v - 2 * qk, n);
+        if (v == 0)
+            return true;
+        qk = qk * qk % n;
+    }
+    return false;
+}
+}
+
+bool isBigPrime(const BigNumber &n) {
+    if (n < limbBase * limbBase) {
+        std::uint64_t high = static_cast<std::uint64_t>(static_cast<long long>(n / limbBase));
+        std::uint64_t low = static_cast<std::uint64_t>(static_cast<long long>(n % limbBase));
+        return isPrime((high << 32) | low);
+    }
+
+    for (std::uint64_t p = 2; p < 1000; ++p) {
+        if (isPrime(p) && (n % static_cast<long long>(p) == 0))
+            return false;
+    }
+
+    return strongProbablePrimeBase2(n) && strongLucasProbablePrime(n);
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef ROOP_BIG_NUMBERS
+#include "BigNumber.h"
+#endif
+
+// Exact primality test for any 64-bit value. Small values are looked up in a sieve that grows on
+// demand and is shared by all the threads, the rest go through a deterministic Miller-Rabin test.
+bool isPrime(std::uint64_t n);
+
+#ifdef ROOP_BIG_NUMBERS
+// Primality test for a value that is not negative. Below 2^64 it is the exact test above, beyond that
+// it is the Baillie-PSW test, which no known composite passes.
+bool isBigPrime(const BigNumber &n);
+#endif
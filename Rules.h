@@ -0,0 +1,452 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Data.h"
+#include "Object.h"
+#include "Operator.h"
+#include <string>
+
+// Handlers of the rules of the operators, one table for each code with a handler for each rule (see
+// Operator::Descriptor). They are in a header so that the programs written by roopc call the handler
+// of each rule directly, which the compiler can inline.
+namespace rules {
+
+// Helpers of the rules, defined in Operator.cpp.
+std::string toLower(std::string s);
+std::string toUpper(std::string s);
+std::string removeString(std::string s, const std::string &toRemove);
+std::string repeatString(const Data &a, const Data &b, const Data &c, bool &success);
+std::string repeatString(const Data &a, const Data &b, bool &success);
+std::string replaceString(std::string s, const std::string &from, const std::string &to);
+void cutString(std::string s, Number pos, SharedString &first, SharedString &last);
+void cutString(std::string s, const std::string &delimiter, SharedString &first, SharedString &last);
+Number reverse(Number n);
+std::string reverse(std::string s);
+Number absolute(Number n);
+Number sign(Number n);
+bool isPrime(Number n);
+Number gcd(Number a, Number b);
+Number find(const std::string &s, const std::string &toFind);
+
+using DType = Data::Type;
+using AllHandler = Operator::AllHandler;
+using AxisHandler = Operator::AxisHandler;
+
+// The handlers write their outcome with these, which set every field of the object, because the
+// Result may still hold the outcome of a previous evaluation.
+inline void setData(Object &obj, const Data &data) {
+    obj.type = Object::Type::Data;
+    obj.data = data;
+}
+
+inline void setType(Object &obj, DType type) {
+    obj.type = Object::Type::Data;
+    obj.data = Data();
+    obj.data.type = type;
+}
+
+inline void setNumber(Object &obj, Number number) {
+    setType(obj, DType::Number);
+    obj.data.number = number;
+}
+
+inline void setString(Object &obj, SharedString string) {
+    setType(obj, DType::String);
+    obj.data.string = std::move(string);
+}
+
+// Most rules of A, S, M, D, R, E and G take two of the three data: up and left, up and right, or
+// left and right.
+enum class Pair {UpLeft, UpRight, LeftRight};
+
+template <Pair pair>
+const Data &firstOf(const Data &up, const Data &left) {
+    return (pair == Pair::LeftRight) ? left : up;
+}
+
+template <Pair pair>
+const Data &secondOf(const Data &left, const Data &right) {
+    return (pair == Pair::UpLeft) ? left : right;
+}
+
+inline void doNothing(Result &/*result*/, const Data &/*first*/, const Data &/*second*/) {
+}
+
+// W and w
+
+inline void outputInput(Result &/*result*/, const Data &/*up*/, const Data &/*left*/, const Data &/*right*/) {
+    Operator::host->output(Operator::host->getInputString());
+}
+
+inline void outputInputNumber(Result &/*result*/, const Data &/*up*/, const Data &/*left*/, const Data &/*right*/) {
+    Operator::host->output(Operator::host->getInputNumber());
+}
+
+inline void outputUp(Result &/*result*/, const Data &up, const Data &/*left*/, const Data &/*right*/) {
+    Operator::host->output(up.toS());
+}
+
+inline void inputString(Result &result, const Data &/*up*/, const Data &/*left*/, const Data &/*right*/) {
+    setString(result.down, Operator::host->getInputString());
+}
+
+inline void inputNumber(Result &result, const Data &/*up*/, const Data &/*left*/, const Data &/*right*/) {
+    setNumber(result.down, Operator::host->getInputNumber());
+}
+
+// C and c
+
+template <bool up, bool left, bool right>
+void bounce(Result &result, const Data &upData, const Data &leftData, const Data &rightData) {
+    if (up) {
+        setData(result.up, upData);
+        result.up.data.direction = util::invert(result.up.data.direction);
+    }
+    if (left) {
+        setData(result.left, leftData);
+        if (result.left.data.direction == util::Dir::Right)
+            result.left.data.direction = util::Dir::Left;
+    }
+    if (right) {
+        setData(result.right, rightData);
+        if (result.right.data.direction == util::Dir::Left)
+            result.right.data.direction = util::Dir::Right;
+    }
+}
+
+inline void swap(Result &result, const Data &first, const Data &second) {
+    setData(result.first, second);
+    setData(result.second, first);
+}
+
+// A, S and M
+
+inline void addAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, up.number + left.number + right.number);
+}
+
+inline void concatenateAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, up.toS() + left.toS() + right.toS());
+}
+
+template <Pair pair>
+void add(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left).number + secondOf<pair>(left, right).number);
+}
+
+template <Pair pair>
+void concatenate(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, firstOf<pair>(up, left).toS() + secondOf<pair>(left, right).toS());
+}
+
+inline void subtractAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, up.number - left.number - right.number);
+}
+
+inline void removeAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, removeString(removeString(up.toS(), left.toS()), right.toS()));
+}
+
+template <Pair pair>
+void subtract(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left).number - secondOf<pair>(left, right).number);
+}
+
+template <Pair pair>
+void remove(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, removeString(firstOf<pair>(up, left).toS(), secondOf<pair>(left, right).toS()));
+}
+
+inline void multiplyAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, up.number * left.number * right.number);
+}
+
+inline void repeatAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, repeatString(up, left, right, result.success));
+}
+
+template <Pair pair>
+void multiply(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left).number * secondOf<pair>(left, right).number);
+}
+
+template <Pair pair>
+void repeat(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, repeatString(firstOf<pair>(up, left), secondOf<pair>(left, right), result.success));
+}
+
+// D and R
+
+inline void divideAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    if ((left.number == 0) || (right.number == 0))
+        result.success = false;
+    else
+        setNumber(result.down, up.number / left.number / right.number);
+}
+
+template <Pair pair>
+void divide(Result &result, const Data &up, const Data &left, const Data &right) {
+    const Data &divisor = secondOf<pair>(left, right);
+    if (divisor.number == 0)
+        result.success = false;
+    else
+        setNumber(result.down, firstOf<pair>(up, left).number / divisor.number);
+}
+
+inline void cutAtPosition(Result &result, const Data &up, const Data &left, const Data &/*right*/) {
+    setType(result.down, DType::String);
+    setType(result.right, DType::String);
+    cutString(up.string.str(), left.number, result.down.data.string, result.right.data.string);
+}
+
+inline void cutAtDelimiter(Result &result, const Data &up, const Data &left, const Data &/*right*/) {
+    setType(result.down, DType::String);
+    setType(result.right, DType::String);
+    cutString(up.string.str(), left.string.str(), result.down.data.string, result.right.data.string);
+}
+
+inline void moduloAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    if ((left.number == 0) || (right.number == 0))
+        result.success = false;
+    else
+        setNumber(result.down, up.number % left.number % right.number);
+}
+
+inline void replaceAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setString(result.down, replaceString(up.toS(), left.toS(), right.toS()));
+}
+
+template <Pair pair>
+void modulo(Result &result, const Data &up, const Data &left, const Data &right) {
+    const Data &divisor = secondOf<pair>(left, right);
+    if (divisor.number == 0)
+        result.success = false;
+    else
+        setNumber(result.down, firstOf<pair>(up, left).number % divisor.number);
+}
+
+// F, E and G
+
+inline void greatestCommonDivisor(Result &result, const Data &up, const Data &left, const Data &/*right*/) {
+    setNumber(result.down, gcd(up.number, left.number));
+}
+
+inline void findString(Result &result, const Data &up, const Data &left, const Data &/*right*/) {
+    setNumber(result.down, find(up.toS(), left.toS()));
+}
+
+inline void equalAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, (up == left) && (up == right));
+}
+
+template <Pair pair>
+void equal(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left) == secondOf<pair>(left, right));
+}
+
+inline void greaterAll(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, (up.number > left.number) && (left.number > right.number));
+}
+
+inline void greaterAllStrings(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, (up.toS() > left.toS()) && (left.toS() > right.toS()));
+}
+
+template <Pair pair>
+void greater(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left).number > secondOf<pair>(left, right).number);
+}
+
+template <Pair pair>
+void greaterStrings(Result &result, const Data &up, const Data &left, const Data &right) {
+    setNumber(result.down, firstOf<pair>(up, left).toS() > secondOf<pair>(left, right).toS());
+}
+
+// L, U, P, Z, N, K and Y
+
+inline void absoluteNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, absolute(first.number));
+}
+
+inline void lowerString(Result &result, const Data &first, const Data &/*second*/) {
+    setString(result.second, toLower(first.string.str()));
+}
+
+inline void signNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, sign(first.number));
+}
+
+inline void upperString(Result &result, const Data &first, const Data &/*second*/) {
+    setString(result.second, toUpper(first.string.str()));
+}
+
+inline void primeNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, isPrime(first.number));
+}
+
+inline void stringLength(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, static_cast<Number>(first.string.size()));
+}
+
+inline void reverseNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, reverse(first.number));
+}
+
+inline void reverseString(Result &result, const Data &first, const Data &/*second*/) {
+    setString(result.second, reverse(first.string.str()));
+}
+
+inline void isEmpty(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, first.empty());
+}
+
+inline void randomNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setNumber(result.second, Operator::host->rand(first.number));
+}
+
+inline void randomCharacter(Result &result, const Data &first, const Data &/*second*/) {
+    if (first.string.empty())
+        setString(result.second, "");
+    else
+        setString(result.second, std::string(1, first.string[static_cast<std::size_t>(Operator::host->rand(static_cast<Number>(first.string.size())))]));
+}
+
+inline void numberToString(Result &result, const Data &first, const Data &/*second*/) {
+    setString(result.second, toString(first.number));
+}
+
+inline void stringToNumber(Result &result, const Data &first, const Data &/*second*/) {
+    setType(result.second, DType::Number);
+    if (!fromString(first.string.str(), result.second.data.number))
+        result.success = false;
+}
+
+inline void toOutput(Result &result, const Data &/*first*/, const Data &/*second*/) {
+    setType(result.second, DType::Output);
+}
+
+inline void toInput(Result &result, const Data &/*first*/, const Data &/*second*/) {
+    setType(result.second, DType::Input);
+}
+
+// V, T, H and h
+
+inline void pass(Result &result, const Data &up, const Data &/*left*/, const Data &/*right*/) {
+    setData(result.down, up);
+}
+
+inline void tick(Result &result, const Data &up, const Data &/*left*/, const Data &/*right*/) {
+    if (up.empty())
+        result.down = Object();
+    else
+        setNumber(result.down, Operator::host->getTick());
+}
+
+inline void halt(Result &/*result*/, const Data &up, const Data &/*left*/, const Data &/*right*/) {
+    if (!up.empty())
+        Operator::host->halt(false);
+}
+
+inline void haltAndPrint(Result &/*result*/, const Data &up, const Data &/*left*/, const Data &/*right*/) {
+    if (!up.empty())
+        Operator::host->halt(true);
+}
+
+
+constexpr AllHandler handlersW[] = {outputInput, outputUp, inputString};
+
+constexpr AllHandler handlersw[] = {outputInputNumber, outputUp, inputNumber};
+
+constexpr AllHandler handlersC[] = {
+    bounce<true, true, true>, bounce<true, true, false>, bounce<true, false, true>, bounce<true, false, false>,
+    bounce<false, true, true>, bounce<false, true, false>, bounce<false, false, true>
+};
+
+constexpr AxisHandler handlersc[] = {swap};
+
+constexpr AxisHandler handlersL[] = {absoluteNumber, lowerString};
+
+constexpr AxisHandler handlersU[] = {signNumber, upperString};
+
+constexpr AllHandler handlersA[] = {
+    addAll, concatenateAll,
+    add<Pair::UpLeft>, concatenate<Pair::UpLeft>,
+    add<Pair::UpRight>, concatenate<Pair::UpRight>,
+    add<Pair::LeftRight>, concatenate<Pair::LeftRight>
+};
+
+constexpr AllHandler handlersS[] = {
+    subtractAll, removeAll,
+    subtract<Pair::UpLeft>, remove<Pair::UpLeft>,
+    subtract<Pair::UpRight>, remove<Pair::UpRight>,
+    subtract<Pair::LeftRight>, remove<Pair::LeftRight>
+};
+
+constexpr AllHandler handlersM[] = {
+    multiplyAll, repeatAll,
+    multiply<Pair::UpLeft>, repeat<Pair::UpLeft>,
+    multiply<Pair::UpRight>, repeat<Pair::UpRight>,
+    multiply<Pair::LeftRight>, repeat<Pair::LeftRight>
+};
+
+constexpr AllHandler handlersD[] = {
+    divideAll, divide<Pair::UpLeft>, divide<Pair::UpRight>, divide<Pair::LeftRight>,
+    cutAtPosition, cutAtDelimiter
+};
+
+constexpr AllHandler handlersR[] = {
+    moduloAll, replaceAll, modulo<Pair::UpLeft>, modulo<Pair::UpRight>, modulo<Pair::LeftRight>
+};
+
+constexpr AllHandler handlersF[] = {greatestCommonDivisor, findString};
+
+constexpr AxisHandler handlersP[] = {primeNumber, stringLength};
+
+constexpr AxisHandler handlersZ[] = {reverseNumber, reverseString};
+
+constexpr AxisHandler handlersN[] = {isEmpty};
+
+constexpr AllHandler handlersE[] = {
+    equalAll, equal<Pair::UpLeft>, equal<Pair::UpRight>, equal<Pair::LeftRight>
+};
+
+constexpr AllHandler handlersG[] = {
+    greaterAll, greaterAllStrings,
+    greater<Pair::UpLeft>, greaterStrings<Pair::UpLeft>,
+    greater<Pair::UpRight>, greaterStrings<Pair::UpRight>,
+    greater<Pair::LeftRight>, greaterStrings<Pair::LeftRight>
+};
+
+constexpr AxisHandler handlersK[] = {randomNumber, randomCharacter};
+
+constexpr AxisHandler handlersY[] = {numberToString, stringToNumber, toOutput, toInput};
+
+constexpr AllHandler handlersV[] = {pass};
+
+constexpr AxisHandler handlersX[] = {doNothing, doNothing, doNothing};
+
+constexpr AllHandler handlersT[] = {tick};
+
+constexpr AllHandler handlersH[] = {halt};
+
+constexpr AllHandler handlersh[] = {haltAndPrint};
+
+}
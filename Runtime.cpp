@@ -0,0 +1,196 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "Runtime.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+Runtime::Runtime(TestManager::Test *test):
+tick        (0),
+ended       (false),
+printAll    (false),
+test        (test),
+randomEngine(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
+observedTick(-1),
+detectCycles(true),
+skippedTicks(0) {
+    Operator::host = this;
+}
+
+std::string Runtime::getInputString() {
+    observedTick = tick;
+    std::string result;
+    std::getline(std::cin, result);
+    return result;
+}
+
+Number Runtime::getInputNumber() {
+    observedTick = tick;
+    Number result;
+    std::string tmp;
+    bool exit = false;
+    do {
+        std::getline(std::cin, tmp);
+        std::stringstream ss(tmp);
+        exit = static_cast<bool>(ss >> result);
+    } while (!exit);
+
+    return result;
+}
+
+void Runtime::output(const std::string &s) {
+    observedTick = tick;
+    std::cout << s;
+}
+
+void Runtime::output(const SharedString &s) {
+    observedTick = tick;
+    std::cout << s;
+}
+
+void Runtime::output(Number n) {
+    observedTick = tick;
+    std::cout << toString(n);
+}
+
+void Runtime::halt(bool print) {
+    observedTick = tick;
+    ended = true;
+    printAll = print;
+}
+
+Number Runtime::rand(Number n) {
+    observedTick = tick;
+    // Limits beyond 64 bits are taken as the closest ones that fit.
+    long long limit = static_cast<long long>(n);
+    if (limit > 0) {
+        return std::uniform_int_distribution<long long>{0, limit - 1}(randomEngine);
+    } else if (limit < 0) {
+        return -std::uniform_int_distribution<long long>{0, -limit - 1}(randomEngine);
+    } else {
+        long long mult = std::uniform_int_distribution<long long>{0, 1}(randomEngine) ? 1: -1;
+        return mult * std::uniform_int_distribution<long long>{}(randomEngine);
+    }
+}
+
+Number Runtime::getTick() {
+    observedTick = tick;
+    return tick;
+}
+
+void Runtime::run() {
+    cycle.hash = grid.getHash();
+    cycle.tick = tick;
+    cycle.power = 1;
+
+    while (!ended) {
+        beginTick();
+
+        if (detectCycles && skipCycle())
+            break;
+
+        firstStage();
+
+        if (test != nullptr) {
+            if (test->tick == tick) {
+                const Data &data = grid.data(grid.index(test->x, test->y));
+                if (test->type == data.type) {
+                    switch (test->type) {
+                        case Data::Type::Number:
+                            test->success = test->number == data.number;
+                            break;
+                        case Data::Type::String:
+                            test->success = test->string == data.string;
+                            break;
+                        default:
+                            test->success = true;
+                            break;
+                    }
+                }
+                ended = true;
+            }
+        }
+
+        if (ended) {
+            if (printAll)
+                printAllObject();
+            break;
+        }
+
+        secondStage();
+        endTick();
+
+        ++tick;
+    }
+}
+
+// Looks for a repetition of the whole grid with Brent's algorithm: the hash at the start of each tick
+// is compared with the one of a checkpoint that moves forward after 1, 2, 4... ticks. The hash has two
+// independent halves of 64 bits (see util::Hash), so a match of both is taken as a repetition without
+// keeping a copy of the grid. When the grid repeats and the program has not used anything besides the
+// grid since the checkpoint, it will go through the same states forever without doing anything else.
+// In that case tests jump over the whole periods before their tick. A program only ends when the grid
+// stays the same from one tick to the next: one that loops through several states keeps running, as
+// it would without the detection. Returns true if it has to end.
+bool Runtime::skipCycle() {
+    util::Hash hash = grid.getHash();
+    Number period = tick - cycle.tick;
+
+    if ((period > 0) && (hash == cycle.hash) && (observedTick < cycle.tick)) {
+        // The states of the loop are known, nothing else can be found.
+        detectCycles = false;
+
+        if (test == nullptr)
+            return period == 1;
+
+        Number skipped = (test->tick - tick) / period * period;
+        tick += skipped;
+        skippedTicks += skipped;
+        return false;
+    }
+
+    if (period == cycle.power) {
+        cycle.hash = hash;
+        cycle.tick = tick;
+        cycle.power *= 2;
+    }
+
+    return false;
+}
+
+void Runtime::printAllObject() {
+    for (std::size_t y = 1; y < grid.getHeight() - 1; ++y) {
+        for (std::size_t x = 1; x < grid.getWidth() - 1; ++x) {
+            std::size_t i = grid.index(x, y);
+            if (grid.type(i) == Object::Type::Data) {
+                const Data &data = grid.data(i);
+                if (data.type == Data::Type::Number) {
+                    output(data.number);
+                } else if (data.type == Data::Type::String) {
+                    output(data.string);
+                } else {
+                    continue;
+                }
+                std::cout << ' ';
+            }
+        }
+    }
+}
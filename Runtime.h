@@ -0,0 +1,94 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Grid.h"
+#include "Movement.h"
+#include "Number.h"
+#include "Operator.h"
+#include "PipeRoutes.h"
+#include "SharedString.h"
+#include "TestManager.h"
+#include "WriteLog.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+// What the interpreter and the programs written by roopc (CompiledProgram) share: the grid, the
+// operators' access to the input, the output, random numbers and the tick (Operator::Host), and the
+// loop of the ticks with the cycle detection and the check of a test. The two stages of a tick are
+// left to the derived classes.
+class Runtime : public Operator::Host {
+public:
+    std::string getInputString() override;
+    Number getInputNumber() override;
+    void output(const std::string &s) override;
+    void output(const SharedString &s) override;
+    void output(Number n) override;
+    void halt(bool print) override;
+    Number rand(Number n) override;
+    Number getTick() override;
+
+    const Grid &getGrid() const;
+protected:
+    // Checkpoint of Brent's cycle detection.
+    struct Cycle {
+        util::Hash hash;
+        Number tick;
+        Number power;
+    };
+
+    explicit Runtime(TestManager::Test *test);
+    ~Runtime() = default;
+
+    // Runs ticks until the program ends, its test is checked or it repeats itself forever.
+    void run();
+
+    // Called at the start of every tick, before the cycle detection, and after its second stage.
+    virtual void beginTick() {}
+    virtual void endTick() {}
+    virtual void firstStage() = 0;
+    virtual void secondStage() = 0;
+
+    bool skipCycle();
+    void printAllObject();
+
+    Number tick;
+    Grid grid;
+    WriteLog writeLog;
+    PipeRoutes pipeRoutes;
+    Movement movement;
+    bool ended;
+    bool printAll;
+    TestManager::Test *test;
+    std::mt19937_64 randomEngine;
+    // Last tick in which the program used something besides the grid: input, output, random numbers,
+    // the tick or halting.
+    Number observedTick;
+    bool detectCycles;
+    Cycle cycle;
+    // Ticks that a test jumped over because the grid repeated.
+    Number skippedTicks;
+};
+
+inline const Grid &Runtime::getGrid() const {
+    return grid;
+}
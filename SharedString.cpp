@@ -0,0 +1,169 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "SharedString.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+SharedString::SharedString() {
+    assign("", 0);
+}
+
+SharedString::SharedString(const char *s) {
+    assign(s, std::strlen(s));
+}
+
+SharedString::SharedString(const std::string &s) {
+    assign(s.data(), s.size());
+}
+
+SharedString::SharedString(std::string &&s) {
+    assign(std::move(s));
+}
+
+SharedString::SharedString(const SharedString &other) {
+    std::memcpy(storage, other.storage, sizeof(storage));
+    if (isShared())
+        getShared()->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+SharedString::SharedString(SharedString &&other) noexcept {
+    std::memcpy(storage, other.storage, sizeof(storage));
+    other.assign("", 0);
+}
+
+SharedString::~SharedString() {
+    release();
+}
+
+SharedString &SharedString::operator=(const SharedString &other) {
+    if (this != &other) {
+        if (other.isShared())
+            other.getShared()->references.fetch_add(1, std::memory_order_relaxed);
+        release();
+        std::memcpy(storage, other.storage, sizeof(storage));
+    }
+    return *this;
+}
+
+SharedString &SharedString::operator=(SharedString &&other) noexcept {
+    if (this != &other) {
+        release();
+        std::memcpy(storage, other.storage, sizeof(storage));
+        other.assign("", 0);
+    }
+    return *this;
+}
+
+std::string SharedString::str() const {
+    return std::string(data(), size());
+}
+
+util::Hash SharedString::hash() const {
+    util::Hash hash;
+    if (isShared()) {
+        hash.first = getShared()->hash.load(std::memory_order_acquire);
+        if (hash.first != 0) {
+            hash.second = getShared()->otherHash.load(std::memory_order_relaxed);
+            return hash;
+        }
+    }
+
+    // FNV-1a for the first half, and mixOther over blocks of 8 characters for the second.
+    const char *characters = data();
+    std::size_t length = size();
+    hash.first = 0xCBF29CE484222325ull;
+    for (std::size_t i = 0; i < length; ++i)
+        hash.first = (hash.first ^ static_cast<unsigned char>(characters[i])) * 0x100000001B3ull;
+    hash.first |= 1;
+
+    hash.second = util::mixOther(length);
+    for (std::size_t i = 0; i < length; i += 8) {
+        std::uint64_t block = 0;
+        std::memcpy(&block, characters + i, std::min<std::size_t>(8, length - i));
+        hash.second = util::mixOther(hash.second ^ block);
+    }
+
+    if (isShared()) {
+        getShared()->otherHash.store(hash.second, std::memory_order_relaxed);
+        getShared()->hash.store(hash.first, std::memory_order_release);
+    }
+    return hash;
+}
+
+void SharedString::assign(const char *s, std::size_t size) {
+    if (size <= inlineCapacity) {
+        std::memcpy(storage, s, size);
+        std::memset(storage + size, 0, inlineCapacity - size);
+        storage[inlineCapacity] = static_cast<char>(inlineCapacity - size);
+    } else {
+        assign(std::string(s, size));
+    }
+}
+
+void SharedString::assign(std::string &&s) {
+    if (s.size() <= inlineCapacity) {
+        assign(s.data(), s.size());
+    } else {
+        setShared(new Shared(std::move(s)));
+    }
+}
+
+void SharedString::release() {
+    if (isShared()) {
+        Shared *shared = getShared();
+        if (shared->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete shared;
+    }
+}
+
+SharedString::Shared *SharedString::getShared() const {
+    Shared *shared;
+    std::memcpy(&shared, storage, sizeof(shared));
+    return shared;
+}
+
+void SharedString::setShared(Shared *shared) {
+    std::memcpy(storage, &shared, sizeof(shared));
+    storage[inlineCapacity] = static_cast<char>(sharedTag);
+}
+
+bool operator==(const SharedString &a, const SharedString &b) {
+    return (a.size() == b.size()) &&
+           ((a.data() == b.data()) || (std::memcmp(a.data(), b.data(), a.size()) == 0));
+}
+
+bool operator!=(const SharedString &a, const SharedString &b) {
+    return !(a == b);
+}
+
+bool operator<(const SharedString &a, const SharedString &b) {
+    int comparison = std::memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    return (comparison < 0) || ((comparison == 0) && (a.size() < b.size()));
+}
+
+bool operator>(const SharedString &a, const SharedString &b) {
+    return b < a;
+}
+
+std::ostream &operator<<(std::ostream &os, const SharedString &s) {
+    return os.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
@@ -0,0 +1,107 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Util.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+
+// Immutable string with reference counted contents, so copying it never copies the characters.
+// Strings of up to 15 characters are stored inline without any allocation.
+class SharedString {
+public:
+    SharedString();
+    SharedString(const char *s);
+    SharedString(const std::string &s);
+    SharedString(std::string &&s);
+    SharedString(const SharedString &other);
+    SharedString(SharedString &&other) noexcept;
+    ~SharedString();
+
+    SharedString &operator=(const SharedString &other);
+    SharedString &operator=(SharedString &&other) noexcept;
+
+    const char *data() const;
+    std::size_t size() const;
+    bool empty() const;
+    char operator[](std::size_t i) const;
+    std::string str() const;
+    // Hash of the characters, computed only once for shared strings.
+    util::Hash hash() const;
+private:
+    // The count is atomic because the first stage can copy the same strings from several threads.
+    struct Shared {
+        Shared(std::string &&string): references(1), string(std::move(string)), hash(0), otherHash(0) {}
+
+        std::atomic<std::size_t> references;
+        std::string string;
+        // The two halves of the Hash, hash is 0 until both are computed.
+        std::atomic<std::uint64_t> hash;
+        std::atomic<std::uint64_t> otherHash;
+    };
+
+    static const std::size_t inlineCapacity = 15;
+    static const unsigned char sharedTag = 0xFF;
+
+    void assign(const char *s, std::size_t size);
+    void assign(std::string &&s);
+    void release();
+
+    bool isShared() const;
+    Shared *getShared() const;
+    void setShared(Shared *shared);
+
+    // Inline strings keep their characters at the beginning and (inlineCapacity - size) in the last byte,
+    // which is also the terminating null character when the string is full. Shared strings keep a pointer
+    // at the beginning and sharedTag in the last byte.
+    alignas(Shared *) char storage[inlineCapacity + 1];
+};
+
+bool operator==(const SharedString &a, const SharedString &b);
+bool operator!=(const SharedString &a, const SharedString &b);
+bool operator<(const SharedString &a, const SharedString &b);
+bool operator>(const SharedString &a, const SharedString &b);
+
+std::ostream &operator<<(std::ostream &os, const SharedString &s);
+
+inline bool SharedString::isShared() const {
+    return static_cast<unsigned char>(storage[inlineCapacity]) == sharedTag;
+}
+
+inline const char *SharedString::data() const {
+    return isShared() ? getShared()->string.data() : storage;
+}
+
+inline std::size_t SharedString::size() const {
+    return isShared() ? getShared()->string.size() : inlineCapacity - static_cast<std::size_t>(storage[inlineCapacity]);
+}
+
+inline bool SharedString::empty() const {
+    return size() == 0;
+}
+
+inline char SharedString::operator[](std::size_t i) const {
+    return data()[i];
+}
@@ -19,9 +19,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "TestManager.h"
 
+#include <iomanip>
+#include <iostream>
 #include <limits>
 
-TestManager::TestManager(std::ifstream &file) {
+TestManager::TestManager(std::istream &file) {
     bool eof = false;
 
     while (!eof) {
@@ -41,7 +43,9 @@ TestManager::TestManager(std::ifstream &file) {
                 break;
             case 'n':
                 test->type = Data::Type::Number;
-                file >> test->number;
+                // Numbers out of range (without ROOP_BIG_NUMBERS) only make the test fail.
+                if (!(file >> test->number))
+                    file.clear();
                 file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 break;
             case 's':
@@ -71,11 +75,9 @@ TestManager::TestManager(std::ifstream &file) {
                 tests.push_back(std::unique_ptr<Test>(test));
                 break;
             } else {
-                test->stream << ch;
+                test->source += ch;
             }
         }
-
-        test->stream << '\n';
     }
 }
 
@@ -86,3 +88,30 @@ std::size_t TestManager::getCount() const {
 TestManager::Test *TestManager::getTest(std::size_t n) {
     return tests[n].get();
 }
+
+void TestManager::printResults() const {
+    std::size_t successCount = 0;
+    std::size_t failCount = 0;
+
+    std::cout << "*********  Tests  *********\n\n";
+
+    for (std::size_t i = 0; i < tests.size(); ++i) {
+        const Test *test = tests[i].get();
+
+        std::cout << std::left << std::setfill(i % 2 ? ' ' : '.')
+                  << std::setw(21) << test->name + ":";
+        if (test->success) {
+            std::cout << " OK\n";
+            ++successCount;
+        } else {
+            std::cout << " Fail\n";
+            ++failCount;
+        }
+    }
+
+    std::cout << "\n---------------------------\n\n";
+
+    std::cout << "OK:    " << successCount << "\n";
+    std::cout << "Fail:  " << failCount << "\n";
+    std::cout << "Total: " << tests.size() << "\n";
+}
@@ -21,15 +21,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "Data.h"
 #include "Number.h"
-#include <fstream>
+#include <istream>
 #include <memory>
-#include <sstream>
+#include <string>
 #include <vector>
 
 class TestManager {
 public:
     struct Test {
-        std::stringstream stream;
+        std::string source;
         std::string name;
         Number tick;
         std::size_t x;
@@ -40,10 +40,12 @@ public:
         bool success = false;
     };
 
-    TestManager(std::ifstream &file);
+    TestManager(std::istream &file);
 
     std::size_t getCount() const;
     Test *getTest(std::size_t n);
+    // Prints the result of each test and the totals.
+    void printResults() const;
 private:
     std::vector<std::unique_ptr<Test>> tests;
 };
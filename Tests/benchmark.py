@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# ROOP - Interpreter for the esoteric programming language ROOP.
+# Copyright (C) 2015 Alejandro O. Coria Bayer
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Timing of the examples that exercise a single path of the interpreter: runs each of them with the
+# profile (-p) and without and with the flags that select that path, and prints the median of the
+# "Time (ms)" lines of the profile (their sum, for the files with several programs) and how many times
+# faster than the run with the default flags it is.
+#
+#     python3 Tests/benchmark.py path/to/roop [--compare NAME=path/to/other-roop]... [--runs N]
+#
+# The paths that have no flag (the string kernels, the primality test, the handler tables and the
+# Numbers of ROOP_BIG_NUMBERS) are compared against another build given with --compare, for example
+# one of the commit before the change, or one with ROOP_BIG_NUMBERS defined. Those builds run each
+# example with the default flags only, since they may not know the others.
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+
+# Example, flags of the runs with the new path. Each example also runs with the default flags first,
+# which is the run the others are compared to.
+BENCHMARKS = [
+    ('multicast.roop', [['-c']]),
+    ('factorial.roop', []),
+    ('fibonacci.roop', []),
+    ('strings.roop', []),
+    ('primes.roop', []),
+    ('dispatch.roop', [['-c']]),
+]
+
+
+def profile_time(roop, flags, path, timeout):
+    """Milliseconds given by the profile of a run, or None if it did not end in time or failed."""
+    try:
+        process = subprocess.run([roop, '-p'] + flags + [path], stdin=subprocess.DEVNULL,
+                                 stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    times = [float(line.split(':', 1)[1]) for line in process.stderr.decode(errors='replace').splitlines()
+             if line.startswith('Time (ms):')]
+    if process.returncode != 0 or not times:
+        return None
+    return sum(times)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Time the examples with and without their paths.')
+    parser.add_argument('roop', help='interpreter to time')
+    parser.add_argument('--compare', action='append', default=[], metavar='NAME=PATH',
+                        help='another build that runs each example with the default flags')
+    parser.add_argument('--examples', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Examples'))
+    parser.add_argument('--runs', type=int, default=3, help='runs of each configuration, the median is shown')
+    parser.add_argument('--timeout', type=float, default=60.0, help='seconds for each run')
+    args = parser.parse_args()
+
+    builds = []
+    for compare in args.compare:
+        name, separator, path = compare.partition('=')
+        if not separator:
+            parser.error('--compare takes NAME=PATH')
+        builds.append((name, path))
+
+    # The examples have CRLF line ends, which the parser only takes as line ends on Windows.
+    path = 'benchmark-test.roop'
+    failures = 0
+    for name, variants in BENCHMARKS:
+        with open(os.path.join(args.examples, name), 'rb') as file:
+            program = file.read().replace(b'\r\n', b'\n')
+        with open(path, 'wb') as file:
+            file.write(program)
+
+        configurations = [('roop', args.roop, [])]
+        configurations += [('roop ' + ' '.join(flags), args.roop, flags) for flags in variants]
+        configurations += [(build, roop, []) for build, roop in builds]
+
+        print(name)
+        reference = None
+        for label, roop, flags in configurations:
+            times = [profile_time(roop, flags, path, args.timeout) for _ in range(args.runs)]
+            if None in times:
+                failures += 1
+                print('    %-28s failed or timed out' % label)
+                continue
+            time = statistics.median(times)
+            if reference is None:
+                reference = time
+            print('    %-28s %10.3f ms  %6.2fx' % (label, time, reference / time if time else 0.0))
+    os.remove(path)
+
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# ROOP - Interpreter for the esoteric programming language ROOP.
+# Copyright (C) 2015 Alejandro O. Coria Bayer
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Differential test of the movement engines: runs every example and a set of random grids with
+# "-m scan" and with each of the other engines, the compiled one (-c) included, and compares the debug
+# output (-d), which shows the grid after every tick.
+#
+#     python3 Tests/movement.py path/to/roop [--seeds N] [--engine="-m event"]...
+#
+# Programs that do not end within the time limit are compared up to the output of the slowest run.
+# A program that gives a different output is written to the current directory to reproduce it.
+
+import argparse
+import os
+import random
+import signal
+import subprocess
+import sys
+import tempfile
+import threading
+
+REFERENCE = ['-m', 'scan']
+ENGINES = ['-m event', '-c']
+# Lines given to the programs that read input.
+INPUT = b'7\nabc\n-3\n' * 200
+
+OPERATORS = 'WwCcLlUuAaSsMmDdRrFfPpZzNnEeGgKkYyVvXTtHh'
+PIPES = '-|+*><%!x'
+
+
+def mixed(rng):
+    """Small grid with every kind of cell, data of all the types included."""
+    width = rng.randint(3, 30)
+    height = rng.randint(3, 25)
+    pool = list(' ' * 30 + '0123456789' + OPERATORS.replace('K', '').replace('k', '') + PIPES * 2 + '###' + 'IO')
+    pool += ['"ab"', "'", '"abcdefghijklmnopqrstuvwxyz0123"', '/ll/', '(123456)', '(-42)']
+    return '\n'.join(''.join(rng.choice(pool) for _ in range(rng.randint(0, width))) for _ in range(height))
+
+
+def dense(rng):
+    """Larger grid mostly full of falling Numbers, with blocks and the pipes that deflect them."""
+    width = rng.randint(5, 80)
+    height = rng.randint(5, 60)
+    pool = list('0123456789' * 3 + ' ' * 12 + '#' + '<>' * 2 + '-|')
+    return '\n'.join(''.join(rng.choice(pool) for _ in range(width)) for _ in range(height))
+
+
+def run(roop, flags, path, timeout, limit):
+    """Output of the program (stdout and stderr, at most limit bytes) and whether it ended before
+    reaching the limit or the timeout."""
+    with tempfile.TemporaryFile() as stdin:
+        stdin.write(INPUT)
+        stdin.seek(0)
+        process = subprocess.Popen([roop, '-d'] + flags + [path], stdin=stdin, stdout=subprocess.PIPE,
+                                   stderr=subprocess.STDOUT, start_new_session=True)
+
+        # The whole process group is killed, in case roop is a script that runs the interpreter.
+        def kill():
+            try:
+                os.killpg(process.pid, signal.SIGKILL)
+            except ProcessLookupError:
+                pass
+
+        timer = threading.Timer(timeout, kill)
+        timer.start()
+        output = b''
+        ended = False
+        while len(output) <= limit:
+            chunk = process.stdout.read1(65536)
+            if not chunk:
+                ended = True
+                break
+            output += chunk
+        timer.cancel()
+        if process.poll() is None:
+            kill()
+        process.stdout.close()
+        # Killed by the timer if the return code is negative.
+        return output[:limit], ended and process.wait() >= 0
+
+
+def same(roop, engine, path, args):
+    expected, expectedComplete = run(roop, REFERENCE, path, args.timeout, args.limit)
+    actual, actualComplete = run(roop, engine, path, args.timeout, args.limit)
+    if expectedComplete and actualComplete:
+        return expected == actual
+    length = min(len(expected), len(actual))
+    return expected[:length] == actual[:length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare the movement engines against the scan.')
+    parser.add_argument('roop', help='interpreter to test')
+    parser.add_argument('--examples', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'Examples'))
+    parser.add_argument('--seeds', type=int, default=200, help='random grids of each kind')
+    parser.add_argument('--engine', action='append', help='flags of an engine to compare (default: event and compiled)')
+    parser.add_argument('--timeout', type=float, default=3.0, help='seconds for each run')
+    parser.add_argument('--limit', type=int, default=200000, help='bytes of output compared')
+    args = parser.parse_args()
+
+    engines = [engine.split() for engine in (args.engine or ENGINES)]
+    failures = 0
+    runs = 0
+
+    def check(name, path):
+        nonlocal failures, runs
+        for engine in engines:
+            runs += 1
+            if not same(args.roop, engine, path, args):
+                failures += 1
+                print('DIFFERENT: %s with %s' % (name, ' '.join(engine)))
+                return False
+        return True
+
+    # The examples have CRLF line ends, which the parser only takes as line ends on Windows.
+    path = 'movement-test.roop'
+    for name in sorted(os.listdir(args.examples)):
+        if name.endswith('.roop'):
+            with open(os.path.join(args.examples, name), 'rb') as file:
+                program = file.read().replace(b'\r\n', b'\n')
+            with open(path, 'wb') as file:
+                file.write(program)
+            check(name, path)
+
+    for kind in (mixed, dense):
+        for seed in range(args.seeds):
+            program = kind(random.Random(seed))
+            with open(path, 'w') as file:
+                file.write(program + '\n')
+            if not check('%s %d' % (kind.__name__, seed), path):
+                with open('movement-%s-%d.roop' % (kind.__name__, seed), 'w') as file:
+                    file.write(program + '\n')
+    os.remove(path)
+
+    print('%d of %d runs differ' % (failures, runs))
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,120 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads):
+threadCount(std::max<std::size_t>(threads, 1)),
+shares     (new Share[threadCount]) {
+    for (std::size_t thread = 1; thread < threadCount; ++thread)
+        workers.emplace_back(&ThreadPool::work, this, thread);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+std::size_t ThreadPool::getThreadCount() const {
+    return threadCount;
+}
+
+void ThreadPool::run(std::size_t count, const std::function<void(std::size_t, std::size_t)> &task) {
+    if (workers.empty() || count <= chunkSize) {
+        if (count > 0)
+            task(0, count);
+        return;
+    }
+
+    for (std::size_t thread = 0; thread < threadCount; ++thread) {
+        shares[thread].next.store(count * thread / threadCount, std::memory_order_relaxed);
+        shares[thread].end = count * (thread + 1) / threadCount;
+    }
+
+    running.store(workers.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        ++generation;
+    }
+    wake.notify_all();
+
+    process(0);
+
+    // The threads that wake up late find nothing left to take, so usually the others are done or about
+    // to be, and a short spin avoids sleeping. A thread that is slow to wake is waited for asleep.
+    for (std::size_t spin = 0; spin < spinCount; ++spin) {
+        if (running.load(std::memory_order_acquire) == 0)
+            return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return running.load(std::memory_order_acquire) == 0; });
+}
+
+void ThreadPool::work(std::size_t thread) {
+    std::size_t done = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != done; });
+            if (stopping)
+                return;
+            done = generation;
+        }
+
+        process(thread);
+
+        if (running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Under the lock, so the caller can not miss it between checking and sleeping.
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.notify_one();
+        }
+    }
+}
+
+void ThreadPool::process(std::size_t thread) {
+    std::size_t begin, end;
+
+    // The own share first, then what is left in the others.
+    for (std::size_t n = 0; n < threadCount; ++n) {
+        Share &share = shares[(thread + n) % threadCount];
+        while (take(share, begin, end))
+            (*task)(begin, end);
+    }
+}
+
+// Takes the next chunk of a share, whichever thread it belongs to.
+bool ThreadPool::take(Share &share, std::size_t &begin, std::size_t &end) {
+    begin = share.next.fetch_add(chunkSize, std::memory_order_relaxed);
+    if (begin >= share.end)
+        return false;
+
+    end = std::min(begin + chunkSize, share.end);
+    return true;
+}
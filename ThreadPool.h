@@ -0,0 +1,77 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that split ranges of indices between them. Every thread starts with an equal
+// share of the range and, when it runs out, takes chunks from the shares of the others. Each share is
+// an atomic counter of its next chunk, so splitting the work takes no locks. The mutex and the
+// condition variables only wake the threads, which sleep between calls, and the caller when the last
+// one finishes.
+class ThreadPool {
+public:
+    // The calling thread also works, so threads - 1 are created.
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t getThreadCount() const;
+
+    // Calls task(begin, end) for chunks covering [0, count) and returns when all of them are done.
+    // The chunks can be processed in any order and by any thread.
+    void run(std::size_t count, const std::function<void(std::size_t, std::size_t)> &task);
+private:
+    // Aligned so that the counters of different threads are not in the same cache line.
+    struct alignas(64) Share {
+        std::atomic<std::size_t> next{0};
+        std::size_t end = 0;
+    };
+
+    static const std::size_t chunkSize = 32;
+    // Checks of the threads still running made by the caller before it sleeps.
+    static const std::size_t spinCount = 4096;
+
+    void work(std::size_t thread);
+    void process(std::size_t thread);
+    bool take(Share &share, std::size_t &begin, std::size_t &end);
+
+    std::size_t threadCount;
+    std::unique_ptr<Share[]> shares;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(std::size_t, std::size_t)> *task = nullptr;
+    std::size_t generation = 0;
+    // Threads created by the pool that have not finished the current call.
+    std::atomic<std::size_t> running{0};
+    bool stopping = false;
+};
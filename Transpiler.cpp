@@ -0,0 +1,402 @@
+#include "Transpiler.h"
+#include "TestManager.h"
+
+#include <sstream>
+
+namespace {
+
+const char *codeNames[] = {"W", "w", "C", "c", "L", "U", "A", "S", "M", "D", "R", "F", "P", "Z",
+                           "N", "E", "G", "K", "Y",
+                           "V", "X", "T", "H", "h"};
+
+const char operators[] = "WwCcLlUuAaSsMmDdRrFfPpZzNnEeGgKkYyVvXTtHh";
+const char pipes[] = "-|+*><%!x";
+
+const char *dirNames[] = {"Up", "Down", "Left", "Right"};
+
+// Character of the layout of a static cell, 0 if there is none.
+char layoutChar(const Object &obj) {
+    if (obj.type == Object::Type::Block)
+        return '#';
+    for (const char *ch = pipes; *ch != 0; ++ch) {
+        Object pipe = Object::CreatePipe(*ch);
+        if ((obj.type == pipe.type) && (obj.pipe.type == pipe.pipe.type))
+            return *ch;
+    }
+    for (const char *ch = operators; *ch != 0; ++ch) {
+        Object op = Object::CreateOperator(*ch);
+        if ((obj.type == op.type) && (obj.op.code == op.op.code) && (obj.op.noRemove == op.op.noRemove))
+            return *ch;
+    }
+    return 0;
+}
+
+// The stages keep each kind as a bit (1 << kindOf), so that a requirement is a mask of the kinds that
+// conform to it. Empty if every kind does.
+std::string conforms(const char *kind, Data::Type type) {
+    unsigned mask = 0;
+    for (std::size_t k = 0; k < dataKinds; ++k) {
+        if ((type == Data::Type::None) || check(type, typeOfKind(k)))
+            mask |= 1u << k;
+    }
+    if (mask == (1u << dataKinds) - 1)
+        return "";
+    std::ostringstream condition;
+    condition << kind << " & 0x" << std::hex << mask << "u";
+    return condition.str();
+}
+
+std::string join(const std::vector<std::string> &conditions) {
+    std::vector<std::string> used;
+    for (const std::string &condition : conditions) {
+        if (!condition.empty())
+            used.push_back(condition);
+    }
+    if (used.size() == 1)
+        return used[0];
+
+    std::string joined;
+    for (const std::string &condition : used)
+        joined += (joined.empty() ? "(" : " && (") + condition + ")";
+    return joined;
+}
+
+}
+
+bool Transpiler::transpile(const char *text, std::size_t size, std::ostream &out) {
+    Interpreter::Options options;
+    bool tests = (size > 0) && (text[0] == '@');
+    std::ostringstream programs;
+    std::size_t count = 0;
+
+    if (tests) {
+        std::istringstream stream(std::string(text + 1, size - 1));
+        TestManager testManager{stream};
+
+        for (; count < testManager.getCount(); ++count) {
+            TestManager::Test *test = testManager.getTest(count);
+            Interpreter interpreter{options, test};
+
+            if (!interpreter.load(test->source.data(), test->source.size()) || !writeProgram(programs, interpreter, count))
+                return false;
+        }
+    } else {
+        Interpreter interpreter{options};
+
+        if (!interpreter.load(text, size) || !writeProgram(programs, interpreter, count++))
+            return false;
+    }
+
+    out << "// Generated by roopc, build it with the sources of the runtime (see the README).\n\n";
+    out << "#include \"CompiledProgram.h\"\n";
+    out << "#include \"Rules.h\"\n";
+    if (tests) {
+        out << "#include \"TestManager.h\"\n\n";
+        out << "#include <sstream>\n";
+        out << "#include <string>\n";
+    }
+    out << "\n";
+    out << programs.str();
+    writeMain(out, text, size, count, tests);
+
+    return static_cast<bool>(out);
+}
+
+// The layout of the grid of the interpreter, its literals, its ports and its first stage.
+bool Transpiler::writeProgram(std::ostream &out, const Interpreter &interpreter, std::size_t n) {
+    const Grid &grid = interpreter.getGrid();
+    const std::size_t cells = grid.getWidth() * grid.getHeight();
+    std::ostringstream layout;
+    std::ostringstream literals;
+    std::ostringstream stage;
+
+    for (std::size_t i = 0; i < cells; ++i) {
+        const Object::Type type = grid.type(i);
+        char ch = ' ';
+
+        if (type == Object::Type::Data) {
+            const Data &data = grid.data(i);
+            if (data.type == Data::Type::Input) {
+                ch = 'I';
+            } else if (data.type == Data::Type::Output) {
+                ch = 'O';
+            } else if (data.type == Data::Type::String) {
+                ch = '@';
+                literals << "    {\"";
+                writeString(literals, data.string.str().data(), data.string.str().size());
+                literals << "\", " << data.string.str().size() << "},\n";
+            } else if (data.type == Data::Type::Number) {
+                const std::string number = toString(data.number);
+                if ((number.size() == 1) && (number[0] >= '0') && (number[0] <= '9')) {
+                    ch = number[0];
+                } else {
+                    ch = '$';
+                    literals << "    {\"" << number << "\", " << number.size() << "},\n";
+                }
+            } else {
+                return false;
+            }
+        } else if (type != Object::Type::Empty) {
+            ch = layoutChar(grid.get(i));
+            if (ch == 0)
+                return false;
+        }
+
+        if (i % grid.getWidth() == 0)
+            layout << (i == 0 ? "" : "\"\n") << "    \"";
+        writeString(layout, &ch, 1);
+    }
+
+    ports.clear();
+    for (std::size_t i = 0; i < cells; ++i) {
+        if (check(grid.type(i), Object::Type::Operator))
+            writeOperator(stage, grid, i);
+    }
+
+    out << "// Program " << n << "\n\n";
+    out << "const char layout" << n << "[] =\n" << layout.str() << "\";\n\n";
+    if (!literals.str().empty())
+        out << "const CompiledProgram::Literal literals" << n << "[] = {\n" << literals.str() << "};\n\n";
+    if (!ports.empty()) {
+        out << "const CompiledProgram::Port ports" << n << "[] = {\n";
+        for (const std::pair<std::size_t, util::Dir> &port : ports)
+            out << "    {" << port.first << ", util::Dir::" << dirNames[static_cast<std::size_t>(port.second)] << "},\n";
+        out << "};\n\n";
+    }
+
+    // Without operators there is nothing to do in the first stage.
+    if (stage.str().empty()) {
+        out << "void stage" << n << "(CompiledProgram &) {\n";
+    } else {
+        out << "void stage" << n << "(CompiledProgram &program) {\n";
+        out << "    Result &result = program.getResult();\n\n";
+    }
+    out << stage.str();
+    out << "}\n\n";
+
+    out << "const CompiledProgram::Definition program" << n << " = {\n";
+    out << "    " << grid.getWidth() << ", " << grid.getHeight() << ", layout" << n << ", ";
+    out << (literals.str().empty() ? "nullptr" : "literals" + std::to_string(n)) << ", ";
+    out << (ports.empty() ? "nullptr" : "ports" + std::to_string(n)) << ", " << ports.size() << ", stage" << n << "\n";
+    out << "};\n\n";
+
+    return true;
+}
+
+// Same as evaluating and applying the operator of the cell in Interpreter::firstStage(). The operator
+// is active if there is Data around it, and no rule matches when there is none.
+void Transpiler::writeOperator(std::ostream &out, const Grid &grid, std::size_t i) {
+    const std::size_t width = grid.getWidth();
+    const Operator op = grid.op(i);
+    const Operator::Descriptor &desc = op.getDescriptor();
+    const Side up    {i - width, "up",    util::Dir::Up};
+    const Side left  {i - 1,     "left",  util::Dir::Left};
+    const Side right {i + 1,     "right", util::Dir::Right};
+    const Side down  {i + width, "down",  util::Dir::Down};
+
+    out << "    {   // " << codeNames[static_cast<std::size_t>(op.code)] << " (" << i % width << ", " << i / width << ")\n";
+    out << "        const unsigned up = 1u << program.kind(" << up.cell << "), left = 1u << program.kind(" << left.cell << ");\n";
+    out << "        const unsigned right = 1u << program.kind(" << right.cell << "), down = 1u << program.kind(" << down.cell << ");\n\n";
+    out << "        if ((up | left | right | down) != 1u) {\n";
+
+    if (desc.separateAxes) {
+        // The rule of each axis is the first one that matches it, and the one of the vertical axis is
+        // applied first unless the horizontal rule comes before it.
+        const Side vertical[] = {up, down};
+        const Side horizontal[] = {left, right};
+        const std::string indent = "            ";
+
+        for (std::size_t v = 0; v <= desc.size; ++v) {
+            std::string condition;
+            if (v < desc.size)
+                condition = join({conforms("up", desc.io[v].req.up), conforms("down", desc.io[v].req.down)});
+            out << indent << (v == 0 ? "" : "} else ") << (condition.empty() ? "{\n" : "if (" + condition + ") {\n");
+
+            for (std::size_t h = 0; (h < desc.size) || (v < desc.size); ++h) {
+                std::string inner;
+                if (h < desc.size)
+                    inner = join({conforms("left", desc.io[h].req.up), conforms("right", desc.io[h].req.down)});
+                out << indent << "    " << (h == 0 ? "" : "} else ") << (inner.empty() ? "{\n" : "if (" + inner + ") {\n");
+                if ((v < desc.size) && (v <= h))
+                    writeRule(out, grid, i, v, vertical, 2, indent + "        ");
+                if (h < desc.size)
+                    writeRule(out, grid, i, h, horizontal, 2, indent + "        ");
+                if ((v < desc.size) && (v > h))
+                    writeRule(out, grid, i, v, vertical, 2, indent + "        ");
+                if (inner.empty())
+                    break;
+            }
+            out << indent << "    }\n";
+            if (condition.empty())
+                break;
+        }
+        out << indent << "}\n";
+    } else {
+        // Only the first rule that matches is applied.
+        const Side sides[] = {up, left, right, down};
+
+        for (std::size_t rule = 0; rule < desc.size; ++rule) {
+            const Operator::DataRequirements &req = desc.io[rule].req;
+            std::string condition = join({conforms("up", req.up), conforms("left", req.left),
+                                          conforms("right", req.right), conforms("down", req.down)});
+
+            out << "            " << (rule == 0 ? "" : "} else ") << (condition.empty() ? "{\n" : "if (" + condition + ") {\n");
+            writeRule(out, grid, i, rule, sides, 4, "                ");
+            if (condition.empty())
+                break;
+        }
+        if (desc.size > 0)
+            out << "            }\n";
+    }
+
+    out << "        }\n";
+    out << "    }\n";
+}
+
+// The rule of the operator of cell i on the given sides: up, left, right and down for processAll(),
+// the two cells of the axis for processAxis(). The outcomes are placed in the same order as
+// Interpreter::apply() does, and the requirements are removed if any of them was placed.
+void Transpiler::writeRule(std::ostream &out, const Grid &grid, std::size_t i, std::size_t rule, const Side *sides, std::size_t count, const std::string &indent) {
+    const Operator op = grid.op(i);
+    const Operator::Descriptor &desc = op.getDescriptor();
+    const Operator::DataRequirements &req = desc.io[rule].req;
+    const Operator::DataOutcome &outcome = desc.io[rule].out;
+    const char *name = codeNames[static_cast<std::size_t>(op.code)];
+    std::vector<std::string> places;
+    std::vector<std::size_t> removed;
+
+    out << indent << "result.success = true;\n";
+    if (count == 4) {
+        const Data::Type outcomes[] = {outcome.up, outcome.left, outcome.right, outcome.down};
+        const char *objects[] = {"result.up", "result.left", "result.right", "result.down"};
+
+        out << indent << "rules::handlers" << name << "[" << rule << "](result, program.data(" << sides[0].cell
+            << "), program.data(" << sides[1].cell << "), program.data(" << sides[2].cell << "));\n";
+        for (std::size_t side = 0; side < 4; ++side) {
+            if (outcomes[side] != Data::Type::None)
+                places.push_back(place(grid, i, objects[side], sides[side]));
+        }
+        // Same order as Interpreter::apply().
+        const Data::Type requirements[] = {req.up, req.down, req.left, req.right};
+        const std::size_t cells[] = {sides[0].cell, sides[3].cell, sides[1].cell, sides[2].cell};
+        for (std::size_t side = 0; side < 4; ++side) {
+            if (requirements[side] != Data::Type::None)
+                removed.push_back(cells[side]);
+        }
+    } else {
+        out << indent << "rules::handlers" << name << "[" << rule << "](result, program.data(" << sides[0].cell
+            << "), program.data(" << sides[1].cell << "));\n";
+        if (outcome.up != Data::Type::None)
+            places.push_back(place(grid, i, "result.first", sides[0]));
+        if (outcome.down != Data::Type::None)
+            places.push_back(place(grid, i, "result.second", sides[1]));
+        if (req.up != Data::Type::None)
+            removed.push_back(sides[0].cell);
+        if (req.down != Data::Type::None)
+            removed.push_back(sides[1].cell);
+    }
+    if (op.noRemove)
+        removed.clear();
+
+    if (places.empty() && removed.empty())
+        return;
+
+    out << indent << "if (result.success) {\n";
+    if (removed.empty()) {
+        for (const std::string &placed : places)
+            out << indent << "    " << placed << ";\n";
+    } else if (places.empty()) {
+        for (std::size_t cell : removed)
+            out << indent << "    program.clearLater(" << cell << ");\n";
+    } else {
+        out << indent << "    bool placed = " << places[0] << ";\n";
+        for (std::size_t n = 1; n < places.size(); ++n)
+            out << indent << "    placed = " << places[n] << " || placed;\n";
+        out << indent << "    if (placed) {\n";
+        for (std::size_t cell : removed)
+            out << indent << "        program.clearLater(" << cell << ");\n";
+        out << indent << "    }\n";
+    }
+    out << indent << "}\n";
+}
+
+// Same as placeObject() in the interpreter, with what the cell can hold known beforehand: pipes,
+// blocks and operators never change.
+std::string Transpiler::place(const Grid &grid, std::size_t i, const std::string &obj, const Side &side) {
+    const Object::Type type = grid.type(side.cell);
+
+    if (grid.op(i).getDescriptor().replace)
+        return "program.replace(" + obj + ", " + std::to_string(side.cell) + ")";
+    if ((type == Object::Type::Pipe) || (type == Object::Type::SpecialOperator)) {
+        ports.emplace_back(side.cell, side.dir);
+        return "program.send(" + obj + ", " + std::to_string(ports.size() - 1) + ")";
+    }
+    if ((type == Object::Type::Empty) || (type == Object::Type::Data))
+        return "program.land(" + obj + ", " + std::to_string(side.cell) + ")";
+    return "program.nowhere(" + obj + ")";
+}
+
+// Text escaped for a string literal.
+void Transpiler::writeString(std::ostream &out, const char *text, std::size_t size) {
+    static const char digits[] = "01234567";
+
+    for (std::size_t i = 0; i < size; ++i) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        switch (ch) {
+            case '\\':
+            case '"':
+            case '?':
+                out << '\\' << ch;
+                break;
+            default:
+                if ((ch < 0x20) || (ch >= 0x7F))
+                    out << '\\' << digits[ch >> 6] << digits[(ch >> 3) & 7] << digits[ch & 7];
+                else
+                    out << ch;
+        }
+    }
+}
+
+// A file of tests keeps its text, one line of the file in each line of the literal, for the expected
+// values of the tests.
+void Transpiler::writeMain(std::ostream &out, const char *text, std::size_t size, std::size_t programs, bool tests) {
+    if (!tests) {
+        out << "int main() {\n";
+        out << "    CompiledProgram program{program0};\n\n";
+        out << "    program.run();\n";
+        out << "    return 0;\n";
+        out << "}\n";
+        return;
+    }
+
+    out << "const char source[] =\n";
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= size; ++i) {
+        if ((i == size) || (text[i] == '\n')) {
+            std::size_t end = (i == size) ? i : i + 1;
+            if ((end > start) || (start == 0)) {
+                out << "    \"";
+                writeString(out, text + start, end - start);
+                out << "\"\n";
+            }
+            start = end;
+        }
+    }
+    out << "    ;\n\n";
+
+    out << "const CompiledProgram::Definition *const programs[] = {\n";
+    for (std::size_t n = 0; n < programs; ++n)
+        out << "    &program" << n << ",\n";
+    out << "};\n\n";
+
+    out << "int main() {\n";
+    out << "    std::istringstream stream(std::string(source + 1, sizeof(source) - 2));\n";
+    out << "    TestManager testManager{stream};\n\n";
+    out << "    for (std::size_t i = 0; i < testManager.getCount(); ++i) {\n";
+    out << "        CompiledProgram program{*programs[i], testManager.getTest(i)};\n\n";
+    out << "        program.run();\n";
+    out << "    }\n\n";
+    out << "    testManager.printResults();\n";
+    out << "    return 0;\n";
+    out << "}\n";
+}
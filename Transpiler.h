@@ -0,0 +1,57 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Interpreter.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Writes a C++ program that runs a ROOP program (or a file of tests) on the runtime of CompiledProgram,
+// without the interpreter. The first stage of each program is straight-line code: every operator cell
+// gets its own block, with the cells of its neighbours, the checks of its rules and the places where
+// its outcomes go fixed, and calls the handler of each rule directly (see Rules.h). The second stage
+// is done by Movement.
+class Transpiler {
+public:
+    // Returns false if the program can not be parsed.
+    bool transpile(const char *text, std::size_t size, std::ostream &out);
+private:
+    // Code of each side of an operator: the cell, the name of its kind in the stage and the direction
+    // from the operator.
+    struct Side {
+        std::size_t cell;
+        const char *kind;
+        util::Dir dir;
+    };
+
+    // Returns false if the grid has something that the layout can not keep.
+    bool writeProgram(std::ostream &out, const Interpreter &interpreter, std::size_t n);
+    void writeOperator(std::ostream &out, const Grid &grid, std::size_t i);
+    void writeRule(std::ostream &out, const Grid &grid, std::size_t i, std::size_t rule, const Side *sides, std::size_t count, const std::string &indent);
+    std::string place(const Grid &grid, std::size_t i, const std::string &obj, const Side &side);
+    void writeString(std::ostream &out, const char *text, std::size_t size);
+    void writeMain(std::ostream &out, const char *text, std::size_t size, std::size_t programs, bool tests);
+
+    // Pipes and special operators that the stage being written sends objects into.
+    std::vector<std::pair<std::size_t, util::Dir>> ports;
+};
@@ -19,6 +19,37 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "Util.h"
 
+#ifdef ROOP_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::size_t> allocationCount{0};
+
+}
+
+// Replacements of the global allocation functions, only to count the allocations. They apply to
+// the whole program, so they are only built when asked for.
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
 namespace util {
 
 Dir invert(Dir dir) {
@@ -30,4 +61,12 @@ Dir invert(Dir dir) {
     }
 }
 
+std::size_t getAllocationCount() {
+#ifdef ROOP_COUNT_ALLOCATIONS
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
 }
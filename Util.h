@@ -19,10 +19,68 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace util {
 
-enum class Dir {Up, Down, Left, Right};
+enum class Dir : std::uint8_t {Up, Down, Left, Right};
 
 Dir invert(Dir dir);
 
+// Number of heap allocations made by the program so far, only counted if ROOP_COUNT_ALLOCATIONS is
+// defined (always 0 otherwise).
+std::size_t getAllocationCount();
+
+// Scrambles the bits of a value (finalizer of splitmix64), used to build hashes.
+inline std::uint64_t mix(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Same purpose as mix with unrelated constants (finalizer of MurmurHash3), for the second half of a
+// Hash.
+inline std::uint64_t mixOther(std::uint64_t value) {
+    value = (value ^ (value >> 33)) * 0xFF51AFD7ED558CCDull;
+    value = (value ^ (value >> 33)) * 0xC4CEB9FE1A85EC53ull;
+    return value ^ (value >> 33);
+}
+
+// Two 64-bit hashes of the same value built independently, the first with mix and the second with
+// mixOther, so that two values only give the same Hash if both of them collide.
+struct Hash {
+    std::uint64_t first = 0;
+    std::uint64_t second = 0;
+};
+
+inline Hash &operator^=(Hash &a, const Hash &b) {
+    a.first ^= b.first;
+    a.second ^= b.second;
+    return a;
+}
+
+inline bool operator==(const Hash &a, const Hash &b) {
+    return (a.first == b.first) && (a.second == b.second);
+}
+
+inline bool operator!=(const Hash &a, const Hash &b) {
+    return !(a == b);
+}
+
+// Position of the lowest set bit of a value that is not 0.
+inline int lowestBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
 }
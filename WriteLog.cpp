@@ -0,0 +1,68 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "WriteLog.h"
+
+void WriteLog::resize(std::size_t size) {
+    entries.assign(size, 0);
+    writes.clear();
+    clears.clear();
+}
+
+void WriteLog::write(std::size_t i, const Object &obj) {
+    if (entries[i] != 0) {
+        writes[entries[i] - 1].second = obj;
+    } else {
+        writes.emplace_back(i, obj);
+        entries[i] = static_cast<std::uint32_t>(writes.size());
+    }
+}
+
+void WriteLog::write(std::size_t i, Object &&obj) {
+    if (entries[i] != 0) {
+        writes[entries[i] - 1].second = std::move(obj);
+    } else {
+        writes.emplace_back(i, std::move(obj));
+        entries[i] = static_cast<std::uint32_t>(writes.size());
+    }
+}
+
+void WriteLog::clearLater(std::size_t i) {
+    clears.push_back(i);
+}
+
+void WriteLog::commit(Grid &grid) {
+    for (auto &write : writes) {
+        grid.set(write.first, std::move(write.second));
+        entries[write.first] = 0;
+    }
+
+    for (std::size_t i : clears) {
+        grid.clear(i);
+    }
+
+    writes.clear();
+    clears.clear();
+}
+
+std::size_t WriteLog::getMemoryUsage() const {
+    return entries.capacity() * sizeof(std::uint32_t)
+         + writes.capacity() * sizeof(std::pair<std::size_t, Object>)
+         + clears.capacity() * sizeof(std::size_t);
+}
@@ -0,0 +1,51 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#pragma once
+
+#include "Grid.h"
+#include "Object.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Changes made to the grid during the first stage. Operators keep reading the grid as it was at the
+// start of the tick while their results are written here, and commit() applies only the touched cells.
+class WriteLog {
+public:
+    void resize(std::size_t size);
+
+    // Type that the cell will have after the commit.
+    Object::Type type(const Grid &grid, std::size_t i) const;
+    void write(std::size_t i, const Object &obj);
+    void write(std::size_t i, Object &&obj);
+    void clearLater(std::size_t i);
+    void commit(Grid &grid);
+
+    std::size_t getMemoryUsage() const;
+private:
+    // For each cell, 0 if it has not been written or the position in 'writes' plus one.
+    std::vector<std::uint32_t> entries;
+    std::vector<std::pair<std::size_t, Object>> writes;
+    std::vector<std::size_t> clears;
+};
+
+inline Object::Type WriteLog::type(const Grid &grid, std::size_t i) const {
+    return entries[i] != 0 ? writes[entries[i] - 1].second.type : grid.type(i);
+}
@@ -18,110 +18,101 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
 #include "Interpreter.h"
+#include "MappedFile.h"
 #include "TestManager.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
 
 void usage();
 
 int main(int argc, char *argv[]) {
-    bool debug = false;
-    char *file;
+    Interpreter::Options options;
+    char *file = nullptr;
 
     if (argc < 2) {
         usage();
         exit(0);
-    } else if (argc > 3) {
-        std::cout << "too many arguments\n\n";
-        usage();
-        exit(0);
     }
 
-    if (argc == 3) {
-        if (std::strcmp(argv[1], "-d") == 0) {
-            debug = true;
-            file = argv[2];
-        } else if (std::strcmp(argv[2], "-d") == 0) {
-            debug = true;
-            file = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-d") == 0) {
+            options.debug = true;
+        } else if (std::strcmp(argv[i], "-p") == 0) {
+            options.profile = true;
+        } else if (std::strcmp(argv[i], "-c") == 0) {
+            options.compiled = true;
+        } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            ++i;
+            char *end;
+            unsigned long threads = std::strtoul(argv[i], &end, 10);
+            if (*end != '\0' || threads == 0) {
+                std::cout << "invalid number of threads (" << argv[i] << ")\n\n";
+                usage();
+                exit(0);
+            }
+            options.threads = threads;
+        } else if (std::strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            ++i;
+            if (std::strcmp(argv[i], "event") == 0) {
+                options.movement = Movement::Engine::Event;
+            } else if (std::strcmp(argv[i], "scan") == 0) {
+                options.movement = Movement::Engine::Scan;
+            } else {
+                std::cout << "unknown movement engine (" << argv[i] << ")\n\n";
+                usage();
+                exit(0);
+            }
+        } else if (file == nullptr) {
+            file = argv[i];
         } else {
             std::cout << "error in arguments\n\n";
             usage();
             exit(0);
         }
-    } else {
-        file = argv[1];
     }
 
+    if (file == nullptr) {
+        std::cout << "missing file\n\n";
+        usage();
+        exit(0);
+    }
 
-    std::ifstream fstream(file);
 
-    if (!fstream.is_open()) {
+    MappedFile program(file);
+
+    if (!program.isOpen()) {
         std::cout << "The file could not be opened (" << file << ")";
         return 1;
     }
 
 
-    char first = '\0';
-    fstream.get(first);
+    if (program.size() > 0 && program.data()[0] == '@') {
+        std::ifstream fstream(file);
+        fstream.ignore(1);
 
-    if (first == '@') {
         TestManager testManager{fstream};
 
         for (std::size_t i = 0; i < testManager.getCount(); ++i) {
             TestManager::Test *test = testManager.getTest(i);
 
-            Interpreter interpreter{debug, test};
+            Interpreter interpreter{options, test};
 
-            if (!interpreter.load(test->stream))
+            if (!interpreter.load(test->source.data(), test->source.size()))
                 return 2;
 
             if (!interpreter.execute())
                 return 3;
         }
 
-        std::size_t successCount = 0;
-        std::size_t failCount = 0;
-
-        std::cout << "*********  Tests  *********\n\n";
-
-        for (std::size_t i = 0; i < testManager.getCount(); ++i) {
-            TestManager::Test *test = testManager.getTest(i);
-
-            std::cout << std::left << std::setfill(i % 2 ? ' ' : '.')
-                      << std::setw(21) << test->name + ":";
-            if (test->success) {
-                std::cout << " OK\n";
-                ++successCount;
-            } else {
-                std::cout << " Fail\n";
-                ++failCount;
-            }
-        }
-
-        std::cout << "\n---------------------------\n\n";
-
-        std::cout << "OK:    " << successCount << "\n";
-        std::cout << "Fail:  " << failCount << "\n";
-        std::cout << "Total: " << testManager.getCount() << "\n";
+        testManager.printResults();
 
     } else {
-        std::stringstream stream;
-
-        if (first != '\0')
-            stream << first;
-
-        stream << fstream.rdbuf();
-        stream.clear();
-        stream << '\n';
-
-        Interpreter interpreter{debug};
+        Interpreter interpreter{options};
 
-        if (!interpreter.load(stream))
+        if (!interpreter.load(program.data(), program.size()))
             return 2;
 
         if (!interpreter.execute())
@@ -132,7 +123,11 @@ int main(int argc, char *argv[]) {
 }
 
 void usage() {
-    std::cout << "roop [-d] file\n\n";
+    std::cout << "roop [-d] [-p] [-c] [-j threads] [-m engine] file\n\n";
     std::cout << "    -d\tDisplay debugging information while running\n";
+    std::cout << "    -p\tDisplay execution statistics at the end\n";
+    std::cout << "    -c\tCache the operators and walls next to each cell (an adjacency cache, not a dataflow engine)\n";
+    std::cout << "    -j\tThreads used to evaluate the operators (1 by default)\n";
+    std::cout << "    -m\tMovement engine: event (default) or scan\n";
     std::cout << "    file\tName of the file to be executed\n\n";
 }
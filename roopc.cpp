@@ -0,0 +1,60 @@
+/*
+ROOP - Interpreter for the esoteric programming language ROOP.
+Copyright (C) 2015 Alejandro O. Coria Bayer
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+#include "MappedFile.h"
+#include "Transpiler.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+void usage();
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        usage();
+        exit(0);
+    }
+
+    MappedFile program(argv[1]);
+
+    if (!program.isOpen()) {
+        std::cout << "The file could not be opened (" << argv[1] << ")";
+        return 1;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary);
+
+    if (!out) {
+        std::cout << "The file could not be created (" << argv[2] << ")";
+        return 1;
+    }
+
+    Transpiler transpiler;
+
+    if (!transpiler.transpile(program.data(), program.size(), out))
+        return 2;
+
+    return 0;
+}
+
+void usage() {
+    std::cout << "roopc file output\n\n";
+    std::cout << "    file\tName of the file to be compiled\n";
+    std::cout << "    output\tC++ file to be written, it is built with the sources of the runtime (see the README)\n\n";
+}